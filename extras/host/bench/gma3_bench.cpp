@@ -0,0 +1,290 @@
+// Micro benchmarks for the encode, decode and control update paths
+// usage: gma3_bench [iterations], prints the results as JSON to stdout
+
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+
+#include "gma3.h"
+#include "MockSink.h"
+
+// allocation counter, all library paths should be allocation free
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+	allocations++;
+	void *memory = malloc(size);
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+	}
+
+void operator delete(void *memory) noexcept {
+	free(memory);
+	}
+
+void operator delete(void *memory, size_t size) noexcept {
+	(void)size;
+	free(memory);
+	}
+
+// UDP sink which discards all packets
+class NullUDP : public UDP {
+	public:
+		uint8_t begin(uint16_t port) override {(void)port; return 1;}
+		void stop() override {}
+		int beginPacket(IPAddress ip, uint16_t port) override {(void)ip; (void)port; return 1;}
+		int beginPacket(const char *host, uint16_t port) override {(void)host; (void)port; return 1;}
+		int endPacket() override {packets++; return 1;}
+		size_t write(uint8_t data) override {(void)data; bytes++; return 1;}
+		size_t write(const uint8_t *buffer, size_t size) override {(void)buffer; bytes += size; return size;}
+		int parsePacket() override {return 0;}
+		int available() override {return 0;}
+		int read() override {return -1;}
+		int read(unsigned char *buffer, size_t length) override {(void)buffer; (void)length; return 0;}
+		int read(char *buffer, size_t length) override {(void)buffer; (void)length; return 0;}
+		int peek() override {return -1;}
+		void flush() override {}
+		IPAddress remoteIP() override {return IPAddress(127, 0, 0, 1);}
+		uint16_t remotePort() override {return 8000;}
+		uint32_t packets = 0;
+		uint32_t bytes = 0;
+	};
+
+// UDP source which returns the packets of a corpus round robin
+class CorpusUDP : public NullUDP {
+	public:
+		void add(const uint8_t *packet, size_t size) {
+			if (count == CORPUS_MAX) return;
+			memcpy(corpus[count].data, packet, size);
+			corpus[count].size = size;
+			count++;
+			}
+		int parsePacket() override {
+			current = &corpus[next];
+			next = (next + 1) % count;
+			position = 0;
+			return current->size;
+			}
+		int available() override {return current->size - position;}
+		int read() override {return position < current->size ? current->data[position++] : -1;}
+		int read(unsigned char *buffer, size_t length) override {
+			size_t size = current->size - position;
+			if (length < size) size = length;
+			memcpy(buffer, current->data + position, size);
+			position += size;
+			return size;
+			}
+		int peek() override {return position < current->size ? current->data[position] : -1;}
+		size_t count = 0;
+
+	private:
+		static const size_t CORPUS_MAX = 16;
+		struct Packet {
+			uint8_t data[256];
+			size_t size;
+			};
+		Packet corpus[CORPUS_MAX];
+		Packet *current = nullptr;
+		size_t next = 0;
+		size_t position = 0;
+	};
+
+// OSC packet writer for the corpus
+class PacketWriter {
+	public:
+		PacketWriter(const char *pattern, const char *tag) {
+			string(pattern);
+			string(tag);
+			}
+		void string(const char *value) {
+			size_t length = strlen(value);
+			memcpy(data + size, value, length);
+			size += length;
+			do data[size++] = 0; while (size % 4);
+			}
+		void int32(int32_t value) {
+			itoh(data, size, value);
+			size += 4;
+			}
+		void float32(float value) {
+			ftoh(data, size, value);
+			size += 4;
+			}
+		uint8_t data[256] = {};
+		size_t size = 0;
+	};
+
+struct Result {
+	const char *name;
+	uint32_t iterations;
+	double ns;
+	size_t allocations;
+	};
+
+static Result results[32];
+static uint8_t resultCount = 0;
+static uint64_t clockUs = 0;
+
+template <typename F> static void bench(const char *name, uint32_t iterations, F operation) {
+	for (uint32_t i = 0; i < iterations / 10 + 1; i++) operation(i); // warm up
+	size_t allocationsStart = allocations;
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; i++) operation(i);
+	auto end = std::chrono::steady_clock::now();
+	Result &result = results[resultCount++];
+	result.name = name;
+	result.iterations = iterations;
+	result.ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+	result.allocations = allocations - allocationsStart;
+	}
+
+static void tick(uint32_t us) {
+	clockUs += us;
+	hostTime(clockUs);
+	}
+
+NullUDP udp;
+CorpusUDP feedback;
+
+Key keys[32] = {101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116,
+	201, 202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216};
+Fader faders[32] = {201, 202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216,
+	301, 302, 303, 304, 305, 306, 307, 308, 309, 310, 311, 312, 313, 314, 315, 316};
+ExecutorKnob knobs[32] = {301, 302, 303, 304, 305, 306, 307, 308, 309, 310, 311, 312, 313, 314, 315, 316,
+	401, 402, 403, 404, 405, 406, 407, 408, 409, 410, 411, 412, 413, 414, 415, 416};
+CmdButton buttons[32] = {"GO+ Macro 1", "GO+ Macro 2", "GO+ Macro 3", "GO+ Macro 4", "GO+ Macro 5", "GO+ Macro 6", "GO+ Macro 7", "GO+ Macro 8",
+	"GO+ Macro 9", "GO+ Macro 10", "GO+ Macro 11", "GO+ Macro 12", "GO+ Macro 13", "GO+ Macro 14", "GO+ Macro 15", "GO+ Macro 16",
+	"Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear", "Clear"};
+Parser parser;
+MockSink ledSink(256); // free output, measures the library
+MockSink spiSink(256, 1000); // 74HC595 chain with 8MHz SPI, 1us per byte
+Indicators<256> leds(ledSink);
+Indicators<256> spiLeds(spiSink);
+const char *numbers[8] = {"1", "13", "201", "9999", "65535", "123456", "-42", "2147483647"};
+volatile uint32_t sink = 0; // keeps the results of the codec benchmarks
+
+static void corpus() {
+	// feedback of the executors as send by the console, pattern is the internal data structure
+	PacketWriter go("/gma3/13.13.1.5.201", ",si");
+	go.string("Go+");
+	go.int32(1);
+	feedback.add(go.data, go.size);
+	PacketWriter release("/gma3/13.13.1.5.201", ",si");
+	release.string("Go+");
+	release.int32(0);
+	feedback.add(release.data, release.size);
+	PacketWriter fader("/gma3/13.13.1.5.201", ",sif");
+	fader.string("FaderMaster");
+	fader.int32(1);
+	fader.float32(75.5f);
+	feedback.add(fader.data, fader.size);
+	PacketWriter flash("/gma3/13.13.1.5.101", ",sii");
+	flash.string("Flash");
+	flash.int32(1);
+	flash.int32(0);
+	feedback.add(flash.data, flash.size);
+	PacketWriter page("/gma3/Page2", ",s");
+	page.string("Page");
+	feedback.add(page.data, page.size);
+	}
+
+int main(int argc, char *argv[]) {
+	uint32_t iterations = 200000;
+	if (argc > 1) iterations = strtoul(argv[1], nullptr, 10);
+	hostTime(0);
+	interface(udp, IPAddress(127, 0, 0, 1), 8000);
+	corpus();
+	gma3.interface(feedback, IPAddress(127, 0, 0, 2), 8000); // the feedback is only received in the parser benchmark
+	gma3.destinationEnable(1, false);
+
+	bench("oscMessage_int32", iterations, [](uint32_t i) {oscMessage("/gma3/Page1/Fader201", (int32_t)i);});
+	bench("oscMessage_float", iterations, [](uint32_t i) {oscMessage("/gma3/Page1/Fader201", (float)i);});
+	bench("oscMessage_string", iterations, [](uint32_t i) {(void)i; oscMessage("/gma3/cmd", "GO+ Macro 1");});
+	bench("oscMessage_nodata", iterations, [](uint32_t i) {(void)i; oscMessage("/gma3/Page1/Key101");});
+	bench("command", iterations, [](uint32_t i) {(void)i; command("GO+ Macro 1");});
+	bench("itod", iterations, [](uint32_t i) {
+		char buffer[12];
+		itod(buffer, i * 7919);
+		sink += buffer[0];
+		});
+	bench("itod_snprintf_reference", iterations, [](uint32_t i) {
+		char buffer[12];
+		snprintf(buffer, sizeof(buffer), "%ld", (long)(i * 7919));
+		sink += buffer[0];
+		});
+	bench("dtoi", iterations, [](uint32_t i) {
+		int32_t value = 0;
+		dtoi(numbers[i & 7], value);
+		sink += value;
+		});
+	bench("dtoi_sscanf_reference", iterations, [](uint32_t i) {
+		int value = 0;
+		sscanf(numbers[i & 7], "%d", &value);
+		sink += value;
+		});
+	bench("parser_update", iterations, [](uint32_t i) {(void)i; parser.update();});
+	parser.filter("13.13.1.5.", 301, 316); // the corpus has no feedback of this executors, all packets are rejected
+	bench("parser_update_filtered", iterations, [](uint32_t i) {(void)i; parser.update();});
+	parser.filterClear();
+	bench("key_update_edge", iterations, [](uint32_t i) {keys[0].update(i & 1);});
+	bench("fader_update_move", iterations, [](uint32_t i) {
+		tick(FADER_UPDATE_RATE_MS * 1000 + 1000);
+		faders[0].update((i & 1) ? 800 : 200);
+		});
+	bench("executorKnob_update_detent", iterations, [](uint32_t i) {knobs[0].update(i & 1, 0);});
+	bench("cmdButton_update_edge", iterations, [](uint32_t i) {buttons[0].update(i & 1);});
+	bench("surface_128_update_idle", iterations / 32, [](uint32_t i) {
+		(void)i;
+		for (uint8_t c = 0; c < 32; c++) {
+			keys[c].update(false);
+			faders[c].update(512);
+			knobs[c].update(1, 0);
+			buttons[c].update(false);
+			}
+		});
+	bench("surface_128_update_active", iterations / 32, [](uint32_t i) {
+		tick(FADER_UPDATE_RATE_MS * 1000 + 1000);
+		for (uint8_t c = 0; c < 32; c++) {
+			keys[c].update(i & 1);
+			faders[c].update((i & 1) ? 800 : 200);
+			knobs[c].update(i & 1, 0);
+			buttons[c].update(i & 1);
+			}
+		});
+
+	leds.frame(0);
+	spiLeds.frame(0);
+	for (uint16_t c = 0; c < 16; c++) {
+		leds.assign(201 + c, c * 3, INDICATOR_LEVEL, "FaderMaster"); // red shows the fader level
+		leds.assign(201 + c, c * 3 + 1, INDICATOR_STATE, "Go+"); // green shows the state
+		}
+	for (uint8_t i = 0; i < 5 && strcmp(parser.stringOSC(), "FaderMaster") != 0; i++) parser.update(); // fader feedback of executor 201
+	bench("indicators_feed", iterations, [](uint32_t i) {(void)i; leds.feed(parser);});
+	bench("indicators_update_idle", iterations, [](uint32_t i) {(void)i; leds.update();});
+	bench("indicators_frame_4_of_256", iterations, [](uint32_t i) {
+		for (uint8_t c = 0; c < 4; c++) leds.set(c * 64, i);
+		leds.update();
+		});
+	bench("indicators_frame_4_of_256_spi", iterations / 100, [](uint32_t i) {
+		for (uint8_t c = 0; c < 4; c++) spiLeds.set(c * 64, i);
+		spiLeds.update();
+		});
+	bench("indicators_frame_256_of_256_spi", iterations / 100, [](uint32_t i) {
+		for (uint16_t c = 0; c < 256; c++) spiLeds.set(c, i + c);
+		spiLeds.update();
+		});
+	static uint8_t image[256];
+	bench("indicators_rewrite_all_spi_reference", iterations / 100, [](uint32_t i) {
+		image[0] = i;
+		spiSink.write(0, image, sizeof(image)); // every loop from user code
+		spiSink.show();
+		});
+
+	printf("{\n  \"library\": \"gma3\",\n  \"iterations\": %u,\n  \"benchmarks\": [\n", iterations);
+	for (uint8_t i = 0; i < resultCount; i++) {
+		printf("    {\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.1f, \"allocations\": %zu}%s\n",
+			results[i].name, results[i].iterations, results[i].ns, results[i].allocations, i + 1 < resultCount ? "," : "");
+		}
+	printf("  ]\n}\n");
+	return 0;
+	}
@@ -0,0 +1,39 @@
+// OSC listener on the host, prints all received packets
+// usage: gma3_listener [port]
+
+#include "Arduino.h"
+#include "PosixUdp.h"
+
+PosixUDP udp;
+uint8_t packet[POSIX_UDP_PACKET_SIZE];
+
+int main(int argc, char *argv[]) {
+	uint16_t port = 8000;
+	if (argc > 1) port = atoi(argv[1]);
+	if (!udp.begin(port)) {
+		fprintf(stderr, "can't bind port %u\n", port);
+		return 1;
+		}
+	while (true) {
+		int size = udp.parsePacket();
+		if (size <= 0) {
+			delay(1);
+			continue;
+			}
+		udp.read(packet, size);
+		Serial.print(millis());
+		Serial.print("ms ");
+		Serial.print(size);
+		Serial.print(" bytes: ");
+		for (int i = 0; i < size; i++) {
+			if (packet[i] >= 0x20 && packet[i] < 0x7F) Serial.print((char)packet[i]);
+			else {
+				char hex[5];
+				snprintf(hex, sizeof(hex), "\\%02X", packet[i]);
+				Serial.print(hex);
+				}
+			}
+		Serial.println();
+		Serial.flush();
+		}
+	}
@@ -0,0 +1,60 @@
+// Fader motion recording on the host, records two virtual faders, saves the recording to a file,
+// loads it into a second recorder and plays it back to an OSC listener on loopback
+// usage: gma3_recorder [file] [console port]
+
+#include "gma3.h"
+#include "PosixUdp.h"
+#include "FilePrint.h"
+#include "FileStream.h"
+
+PosixUDP udp;
+IPAddress gma3IP(127, 0, 0, 1);
+uint16_t gma3UdpPort = 8000;
+const char *path = "faders.rec";
+
+Fader fader201(201);
+Fader fader202(202);
+
+uint8_t recordArena[512];
+uint8_t playArena[512];
+Recorder recorder(recordArena, sizeof(recordArena));
+Recorder player(playArena, sizeof(playArena));
+
+int main(int argc, char *argv[]) {
+	if (argc > 1) path = argv[1];
+	if (argc > 2) gma3UdpPort = atoi(argv[2]);
+	udp.begin(gma3UdpPort + 1);
+	destination(udp, gma3IP, gma3UdpPort);
+
+	recorder.record();
+	for (int step = 0; step <= 100; step++) { // fader 202 follows fader 201 in the opposite direction
+		fader201.update(step * 10);
+		fader202.update(1023 - step * 10);
+		delay(FADER_UPDATE_RATE_MS + 1);
+		}
+	recorder.stop();
+	uint32_t recorded = statistics().packetsSent;
+
+	FilePrint output;
+	if (!output.open(path)) {
+		fprintf(stderr, "can't write %s\n", path);
+		return 1;
+		}
+	size_t size = recorder.save(output);
+	output.close();
+	FileStream input;
+	if (!input.open(path) || !player.load(input)) {
+		fprintf(stderr, "can't read %s\n", path);
+		return 1;
+		}
+
+	uint32_t start = millis();
+	player.play();
+	while (player.playing()) {
+		player.update();
+		delay(1);
+		}
+	printf("recorded %u values in %u bytes, %u ms, file %zu bytes, played %u values in %u ms\n",
+		recorded, recorder.size(), recorder.duration(), size, statistics().packetsSent - recorded, (uint32_t)(millis() - start));
+	return 0;
+	}
@@ -0,0 +1,56 @@
+// Surface snapshot on the host, the first run sets up a surface state and saves it to a file,
+// the next run recalls it like after a power-up and sends the fader values as one bundle
+// usage: gma3_snapshot [file] [console port]
+
+#include "gma3.h"
+#include "PosixUdp.h"
+#include "FileStorage.h"
+
+PosixUDP udp;
+FileStorage storage;
+IPAddress gma3IP(127, 0, 0, 1);
+uint16_t gma3UdpPort = 8000;
+const char *path = "surface.snp";
+
+Key key101(101);
+Key key102(102);
+Fader fader201(201);
+Fader fader202(202);
+Fader fader203(203);
+ExecutorKnob enc301(301);
+Pages pages(1, 4);
+
+int main(int argc, char *argv[]) {
+	if (argc > 1) path = argv[1];
+	if (argc > 2) gma3UdpPort = atoi(argv[2]);
+	udp.begin(gma3UdpPort + 1);
+	destination(udp, gma3IP, gma3UdpPort);
+	if (!storage.open(path)) {
+		fprintf(stderr, "can't open %s\n", path);
+		return 1;
+		}
+
+	if (gma3.snapshotRecall(storage)) {
+		printf("recalled page %u, fader values %d %d %d, fader 203 %s, sent %u packets\n", pages.currentPage(),
+			fader201.value(), fader202.value(), fader203.value(), fader203.lock() ? "locked" : "unlocked", statistics().packetsSent);
+		return 0;
+		}
+
+	pages.update(true, false); // page 2
+	pages.update(false, false);
+	pages.update(true, false); // page 3
+	key102.page(5);
+	enc301.pool(2);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader201.update(300);
+	fader202.update(700);
+	fader203.update(1000);
+	fader203.fetch(20);
+	if (!gma3.snapshotSave(storage)) {
+		fprintf(stderr, "can't write %s\n", path);
+		return 1;
+		}
+	printf("saved page %u, fader values %d %d %d, snapshot %u bytes, run again to recall\n", pages.currentPage(),
+		fader201.value(), fader202.value(), fader203.value(), gma3.snapshotSize());
+	return 0;
+	}
@@ -0,0 +1,57 @@
+// Virtual surface on the host, sends to an OSC listener on loopback
+// usage: gma3_surface [console port] [local port] [capture file]
+
+#include "gma3.h"
+#include "PosixUdp.h"
+#include "FilePrint.h"
+
+PosixUDP udp;
+FilePrint captureFile;
+IPAddress gma3IP(127, 0, 0, 1);
+uint16_t gma3UdpPort = 8000;
+uint16_t localUdpPort = 8001;
+
+Key key101(101);
+Fader fader201(201);
+ExecutorKnob enc301(301);
+CmdButton macro1("GO+ Macro 1");
+Pages pages(1, 4);
+
+void parse();
+Parser parser(parse);
+
+int main(int argc, char *argv[]) {
+	if (argc > 1) gma3UdpPort = atoi(argv[1]);
+	if (argc > 2) localUdpPort = atoi(argv[2]);
+	if (argc > 3 && captureFile.open(argv[3])) gma3.capture(captureFile);
+	udp.begin(localUdpPort); // the console port is used by the listener on loopback
+	destination(udp, gma3IP, gma3UdpPort);
+	pages.resync();
+
+	for (int step = 0; step <= 100; step++) {
+		fader201.update(step * 10);
+		key101.update(step % 20 < 10);
+		enc301.update(step % 2, 0);
+		macro1.update(step == 50);
+		pages.update(step % 25 == 0, false);
+		parser.update();
+		delay(FADER_UPDATE_RATE_MS + 1);
+		}
+	gma3.captureStop();
+	return 0;
+	}
+
+void parse() {
+	Serial.print("OSC Message at ");
+	Serial.print(millis());
+	Serial.print("ms Pattern: ");
+	Serial.print(parser.patternOSC());
+	Serial.print(" String: ");
+	Serial.print(parser.stringOSC());
+	Serial.print(" Integer 1: ");
+	Serial.print(parser.int1OSC());
+	Serial.print(" Integer 2: ");
+	Serial.print(parser.int2OSC());
+	Serial.print(" Float: ");
+	Serial.println(parser.floatOSC());
+	}
@@ -0,0 +1,98 @@
+// Threaded mode on the host, an input thread scans the controls and a network thread sends and parses
+// usage: gma3_threads [seconds] [console port] [network delay us] [idle timeout ms]
+// the network delay simulates a slow interface, the input scan interval is not affected
+// with an idle timeout the controls rest every other 500ms, the sent packets are echoed to the Parser
+// as feedback and a third thread calls wake() like an interrupt
+
+#include <atomic>
+#include <thread>
+
+#include "gma3.h"
+#include "PosixUdp.h"
+
+PosixUDP udp;
+IPAddress gma3IP(127, 0, 0, 1);
+uint16_t gma3UdpPort = 8000;
+uint32_t networkDelay = 0;
+uint32_t idleTimeout = 0;
+std::atomic<bool> running(true);
+
+Key key101(101);
+Fader fader201(201);
+ExecutorKnob enc301(301);
+Pages pages(1, 4);
+Parser parser;
+
+uint32_t scans = 0;
+uint32_t scanGapMax = 0; // us
+uint32_t idleSkips = 0; // loops without scan
+std::atomic<uint32_t> wakes(0);
+
+void input() {
+	uint32_t last = micros();
+	while (running) {
+		uint32_t now = micros();
+		if (now - last > scanGapMax) scanGapMax = now - last;
+		last = now;
+		if (gma3.scanning()) { // always true without idle mode
+			uint32_t step = idleTimeout > 0 && (millis() / 500) % 2 ? 0 : scans; // controls at rest
+			fader201.update(step % 1024);
+			key101.update(step % 200 < 100);
+			enc301.update(step % 2, 0);
+			pages.update(step % 2500 == 0, false);
+			if (step % 1000 == 0 && step > 0) prefixName(step % 2000 == 0 ? "gma3" : "desk"); // published with the seqlock
+			}
+		else idleSkips++;
+		gma3.update();
+		scans++;
+		delayMicroseconds(100);
+		}
+	}
+
+void network() {
+	while (running) {
+		gma3.transmit();
+		parser.update();
+		if (networkDelay > 0) delayMicroseconds(networkDelay);
+		else delayMicroseconds(50);
+		}
+	gma3.transmit();
+	}
+
+void interrupt() {
+	while (running) {
+		delay(300);
+		gma3.wake();
+		wakes++;
+		}
+	}
+
+int main(int argc, char *argv[]) {
+	uint32_t seconds = 2;
+	if (argc > 1) seconds = atoi(argv[1]);
+	if (argc > 2) gma3UdpPort = atoi(argv[2]);
+	if (argc > 3) networkDelay = atoi(argv[3]);
+	if (argc > 4) idleTimeout = atoi(argv[4]);
+	udp.begin(gma3UdpPort + 1);
+	destination(udp, gma3IP, gma3UdpPort);
+	if (idleTimeout > 0) {
+		destination(udp, gma3IP, gma3UdpPort + 1); // echo as feedback, received packets are activity of the network thread
+		gma3.idle(idleTimeout, 20);
+		}
+	gma3.threaded(true); // before the threads are started
+
+	std::thread inputThread(input);
+	std::thread networkThread(network);
+	std::thread interruptThread(interrupt);
+	delay(seconds * 1000);
+	running = false;
+	inputThread.join();
+	networkThread.join();
+	interruptThread.join();
+
+	const struct Statistics &stats = statistics();
+	printf("scans %u, max scan gap %u us, packets sent %u, received %u, queue drops %u, send failures %u\n",
+		scans, scanGapMax, stats.packetsSent, stats.packetsReceived, stats.queueDrops, stats.sendFailures);
+	if (idleTimeout > 0) printf("idle skips %u, wakes %u\n", idleSkips, wakes.load());
+	return 0;
+	}
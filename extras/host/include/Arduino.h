@@ -0,0 +1,97 @@
+/*
+Arduino compatibility layer for the host build of the gma3 library
+*/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "avr/pgmspace.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define HOST_PINS 256
+
+/**
+ * @brief Time functions, the clock is the real monotonic clock of the host
+ * until hostTime() sets a manual clock
+ *
+ */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+/**
+ * @brief Pin functions, the inputs are driven by hostDigital() and hostAnalog()
+ *
+ */
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+/**
+ * @brief Set the state of a digital input pin, pins with INPUT_PULLUP start HIGH
+ *
+ * @param pin
+ * @param value HIGH or LOW
+ */
+void hostDigital(uint8_t pin, int value);
+
+/**
+ * @brief Set the value of an analog input pin
+ *
+ * @param pin
+ * @param value 10 bit value
+ */
+void hostAnalog(uint8_t pin, int value);
+
+/**
+ * @brief Switch to a manual clock and set the time
+ *
+ * @param us time in microseconds
+ */
+void hostTime(uint64_t us);
+
+/**
+ * @brief Switch back to the real clock of the host
+ *
+ */
+void hostTimeReal();
+
+/**
+ * @brief Serial port which writes to stdout
+ *
+ */
+class HostSerial : public Stream {
+	public:
+		void begin(unsigned long baud) {(void)baud;}
+		size_t write(uint8_t data) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		int available() override {return 0;}
+		int read() override {return -1;}
+		int peek() override {return -1;}
+		void flush() override;
+		using Print::write;
+	};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,26 @@
+/*
+File output for the host build of the gma3 library, e.g. for the traffic capture
+*/
+
+#ifndef FILE_PRINT_H
+#define FILE_PRINT_H
+
+#include <stdio.h>
+
+#include "Print.h"
+
+class FilePrint : public Print {
+	public:
+		~FilePrint();
+		bool open(const char *path, const char *mode = "wb");
+		void close();
+		size_t write(uint8_t data) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		void flush() override;
+		using Print::write;
+
+	private:
+		FILE *file = nullptr;
+	};
+
+#endif
@@ -0,0 +1,25 @@
+/*
+File backed non-volatile memory for the host build of the gma3 library, e.g. for the snapshots
+*/
+
+#ifndef FILE_STORAGE_H
+#define FILE_STORAGE_H
+
+#include <stdio.h>
+
+#include "gma3.h"
+
+class FileStorage : public SnapshotStorage {
+	public:
+		~FileStorage();
+		bool open(const char *path); // the file is created if it not exists
+		void close();
+		bool read(uint32_t address, uint8_t *data, uint16_t size) override;
+		bool write(uint32_t address, const uint8_t *data, uint16_t size) override;
+		bool commit() override;
+
+	private:
+		FILE *file = nullptr;
+	};
+
+#endif
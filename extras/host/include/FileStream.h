@@ -0,0 +1,27 @@
+/*
+File input for the host build of the gma3 library, e.g. for recordings written with FilePrint
+*/
+
+#ifndef FILE_STREAM_H
+#define FILE_STREAM_H
+
+#include <stdio.h>
+
+#include "Stream.h"
+
+class FileStream : public Stream {
+	public:
+		~FileStream();
+		bool open(const char *path, const char *mode = "rb");
+		void close();
+		int available() override;
+		int read() override;
+		int peek() override;
+		size_t write(uint8_t data) override;
+		using Print::write;
+
+	private:
+		FILE *file = nullptr;
+	};
+
+#endif
@@ -0,0 +1,35 @@
+/*
+Arduino compatibility layer for the host build of the gma3 library
+*/
+
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+#include <string.h>
+
+class IPAddress {
+	public:
+		IPAddress() {memset(address, 0, sizeof(address));}
+		IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) {
+			address[0] = first;
+			address[1] = second;
+			address[2] = third;
+			address[3] = fourth;
+			}
+		IPAddress(uint32_t raw) {memcpy(address, &raw, sizeof(address));} // network byte order like the Arduino cores
+		operator uint32_t() const {
+			uint32_t raw;
+			memcpy(&raw, address, sizeof(raw));
+			return raw;
+			}
+		bool operator==(const IPAddress &other) const {return memcmp(address, other.address, sizeof(address)) == 0;}
+		bool operator!=(const IPAddress &other) const {return !(*this == other);}
+		uint8_t operator[](int index) const {return address[index];}
+		uint8_t& operator[](int index) {return address[index];}
+
+	private:
+		uint8_t address[4];
+	};
+
+#endif
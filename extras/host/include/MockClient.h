@@ -0,0 +1,36 @@
+/*
+TCP client for the host build of the gma3 library without sockets, keeps the written bytes
+and returns the queued bytes as received, e.g. for the tests
+*/
+
+#ifndef MOCK_CLIENT_H
+#define MOCK_CLIENT_H
+
+#include <deque>
+#include <vector>
+
+#include "Client.h"
+
+class MockClient : public Client {
+	public:
+		int connect(IPAddress ip, uint16_t port) override;
+		int connect(const char *host, uint16_t port) override;
+		size_t write(uint8_t data) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		int available() override;
+		int read() override;
+		int read(uint8_t *buffer, size_t size) override;
+		int peek() override;
+		void flush() override;
+		void stop() override;
+		uint8_t connected() override;
+		operator bool() override;
+		void receive(const uint8_t *data, size_t size); // queue bytes for read(), e.g. a part of a message
+		std::vector<uint8_t> written;
+		bool up = true; // false simulates a lost connection
+
+	private:
+		std::deque<uint8_t> incoming;
+	};
+
+#endif
@@ -0,0 +1,28 @@
+/*
+Indicator sink for the host build of the gma3 library, counts the output and keeps an image of the channels,
+an optional transfer time per byte simulates the bus, e.g. 1000ns for a 74HC595 chain with 8MHz SPI
+*/
+
+#ifndef MOCK_SINK_H
+#define MOCK_SINK_H
+
+#include <vector>
+
+#include "gma3.h"
+
+class MockSink : public IndicatorSink {
+	public:
+		MockSink(uint16_t channels, uint32_t byteTime = 0);
+		void write(uint16_t channel, const uint8_t *values, uint16_t count) override;
+		void show() override;
+		void reset();
+		std::vector<uint8_t> image;
+		uint32_t writes = 0; // runs of channels
+		uint32_t bytes = 0;
+		uint32_t frames = 0;
+
+	private:
+		uint32_t byteTime; // ns
+	};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+UDP interface for the host build of the gma3 library without sockets, keeps the sent packets
+and returns the queued packets as received, e.g. for the tests
+*/
+
+#ifndef MOCK_UDP_H
+#define MOCK_UDP_H
+
+#include <deque>
+#include <vector>
+
+#include "Udp.h"
+
+class MockUdp : public UDP {
+	public:
+		uint8_t begin(uint16_t port) override;
+		void stop() override;
+		int beginPacket(IPAddress ip, uint16_t port) override;
+		int beginPacket(const char *host, uint16_t port) override;
+		int endPacket() override;
+		size_t write(uint8_t data) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		int parsePacket() override;
+		int available() override;
+		int read() override;
+		int read(unsigned char *buffer, size_t length) override;
+		int read(char *buffer, size_t length) override;
+		int peek() override;
+		void flush() override;
+		IPAddress remoteIP() override;
+		uint16_t remotePort() override;
+		void receive(const uint8_t *packet, size_t size); // queue a packet for parsePacket()
+		std::vector<std::vector<uint8_t>> sent;
+		bool up = true; // false simulates a failed send
+
+	private:
+		std::deque<std::vector<uint8_t>> inbox;
+		std::vector<uint8_t> packet; // sent packet in progress
+		std::vector<uint8_t> current; // received packet
+		size_t position = 0;
+	};
+
+#endif
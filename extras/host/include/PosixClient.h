@@ -0,0 +1,30 @@
+/*
+TCP client for the host build of the gma3 library based on POSIX sockets
+*/
+
+#ifndef POSIX_CLIENT_H
+#define POSIX_CLIENT_H
+
+#include "Client.h"
+
+class PosixClient : public Client {
+	public:
+		~PosixClient();
+		int connect(IPAddress ip, uint16_t port) override;
+		int connect(const char *host, uint16_t port) override;
+		size_t write(uint8_t data) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		int available() override;
+		int read() override;
+		int read(uint8_t *buffer, size_t size) override;
+		int peek() override;
+		void flush() override;
+		void stop() override;
+		uint8_t connected() override;
+		operator bool() override;
+
+	private:
+		int socketHandle = -1;
+	};
+
+#endif
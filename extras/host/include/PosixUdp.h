@@ -0,0 +1,46 @@
+/*
+UDP socket for the host build of the gma3 library based on POSIX sockets
+*/
+
+#ifndef POSIX_UDP_H
+#define POSIX_UDP_H
+
+#include "Udp.h"
+
+#define POSIX_UDP_PACKET_SIZE 65536
+
+class PosixUDP : public UDP {
+	public:
+		~PosixUDP();
+		uint8_t begin(uint16_t port) override;
+		void stop() override;
+		int beginPacket(IPAddress ip, uint16_t port) override;
+		int beginPacket(const char *host, uint16_t port) override;
+		int endPacket() override;
+		size_t write(uint8_t data) override;
+		size_t write(const uint8_t *buffer, size_t size) override;
+		int parsePacket() override;
+		int available() override;
+		int read() override;
+		int read(unsigned char *buffer, size_t length) override;
+		int read(char *buffer, size_t length) override;
+		int peek() override;
+		void flush() override;
+		IPAddress remoteIP() override;
+		uint16_t remotePort() override;
+
+	private:
+		bool open();
+		int socketHandle = -1;
+		IPAddress sendIp;
+		uint16_t sendPort = 0;
+		uint8_t sendBuffer[POSIX_UDP_PACKET_SIZE];
+		size_t sendSize = 0;
+		uint8_t receiveBuffer[POSIX_UDP_PACKET_SIZE];
+		size_t receiveSize = 0;
+		size_t receivePosition = 0;
+		IPAddress receiveIp;
+		uint16_t receivePort = 0;
+	};
+
+#endif
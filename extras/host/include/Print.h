@@ -0,0 +1,47 @@
+/*
+Arduino compatibility layer for the host build of the gma3 library
+*/
+
+#ifndef PRINT_H
+#define PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// strings in flash memory, e.g. F("text")
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper*>(string))
+
+#define DEC 10
+#define HEX 16
+
+class Print {
+	public:
+		virtual ~Print() {}
+		virtual size_t write(uint8_t data) = 0;
+		virtual size_t write(const uint8_t *buffer, size_t size);
+		size_t write(const char *string) {return write((const uint8_t*)string, strlen(string));}
+		virtual void flush() {}
+
+		size_t print(const __FlashStringHelper *string) {return print(reinterpret_cast<const char*>(string));}
+		size_t print(const char string[]);
+		size_t print(char c);
+		size_t print(int number, int base = DEC);
+		size_t print(unsigned int number, int base = DEC);
+		size_t print(long number, int base = DEC);
+		size_t print(unsigned long number, int base = DEC);
+		size_t print(double number, int digits = 2);
+
+		size_t println();
+		size_t println(const __FlashStringHelper *string) {return println(reinterpret_cast<const char*>(string));}
+		size_t println(const char string[]);
+		size_t println(char c);
+		size_t println(int number, int base = DEC);
+		size_t println(unsigned int number, int base = DEC);
+		size_t println(long number, int base = DEC);
+		size_t println(unsigned long number, int base = DEC);
+		size_t println(double number, int digits = 2);
+	};
+
+#endif
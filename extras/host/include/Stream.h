@@ -0,0 +1,18 @@
+/*
+Arduino compatibility layer for the host build of the gma3 library
+*/
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+	public:
+		virtual int available() = 0;
+		virtual int read() = 0;
+		virtual int peek() = 0;
+		size_t readBytes(uint8_t *buffer, size_t length);
+	};
+
+#endif
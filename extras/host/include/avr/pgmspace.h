@@ -0,0 +1,26 @@
+/*
+Arduino compatibility layer for the host build of the gma3 library,
+the host has no separate flash memory, so the _P functions use the RAM functions
+*/
+
+#ifndef PGMSPACE_H
+#define PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(string) (string)
+
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+
+#endif
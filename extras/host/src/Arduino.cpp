@@ -0,0 +1,88 @@
+#include "Arduino.h"
+
+#include <time.h>
+#include <unistd.h>
+
+HostSerial Serial;
+
+static int pinDigital[HOST_PINS];
+static int pinAnalog[HOST_PINS];
+static bool timeManual = false;
+static uint64_t timeValue = 0;
+
+static uint64_t timeNow() {
+	if (timeManual) return timeValue;
+	static uint64_t timeStart = 0;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t now = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+	if (timeStart == 0) timeStart = now;
+	return now - timeStart;
+	}
+
+unsigned long millis() {
+	return (unsigned long)(timeNow() / 1000);
+	}
+
+unsigned long micros() {
+	return (unsigned long)timeNow();
+	}
+
+void delay(unsigned long ms) {
+	if (timeManual) timeValue += (uint64_t)ms * 1000;
+	else usleep(ms * 1000);
+	}
+
+void delayMicroseconds(unsigned int us) {
+	if (timeManual) timeValue += us;
+	else usleep(us);
+	}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	if (mode == INPUT_PULLUP) pinDigital[pin] = HIGH;
+	}
+
+int digitalRead(uint8_t pin) {
+	return pinDigital[pin];
+	}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	pinDigital[pin] = value;
+	}
+
+int analogRead(uint8_t pin) {
+	return pinAnalog[pin];
+	}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+	return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+	}
+
+void hostDigital(uint8_t pin, int value) {
+	pinDigital[pin] = value;
+	}
+
+void hostAnalog(uint8_t pin, int value) {
+	pinAnalog[pin] = value;
+	}
+
+void hostTime(uint64_t us) {
+	timeManual = true;
+	timeValue = us;
+	}
+
+void hostTimeReal() {
+	timeManual = false;
+	}
+
+size_t HostSerial::write(uint8_t data) {
+	return fwrite(&data, 1, 1, stdout);
+	}
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size) {
+	return fwrite(buffer, 1, size, stdout);
+	}
+
+void HostSerial::flush() {
+	fflush(stdout);
+	}
@@ -0,0 +1,29 @@
+#include "FilePrint.h"
+
+FilePrint::~FilePrint() {
+	close();
+	}
+
+bool FilePrint::open(const char *path, const char *mode) {
+	close();
+	file = fopen(path, mode);
+	return file != nullptr;
+	}
+
+void FilePrint::close() {
+	if (file != nullptr) fclose(file);
+	file = nullptr;
+	}
+
+size_t FilePrint::write(uint8_t data) {
+	return write(&data, 1);
+	}
+
+size_t FilePrint::write(const uint8_t *buffer, size_t size) {
+	if (file == nullptr) return 0;
+	return fwrite(buffer, 1, size, file);
+	}
+
+void FilePrint::flush() {
+	if (file != nullptr) fflush(file);
+	}
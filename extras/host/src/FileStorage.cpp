@@ -0,0 +1,31 @@
+#include "FileStorage.h"
+
+FileStorage::~FileStorage() {
+	close();
+	}
+
+bool FileStorage::open(const char *path) {
+	close();
+	file = fopen(path, "r+b");
+	if (file == nullptr) file = fopen(path, "w+b");
+	return file != nullptr;
+	}
+
+void FileStorage::close() {
+	if (file != nullptr) fclose(file);
+	file = nullptr;
+	}
+
+bool FileStorage::read(uint32_t address, uint8_t *data, uint16_t size) {
+	if (file == nullptr || fseek(file, address, SEEK_SET) != 0) return false;
+	return fread(data, 1, size, file) == size;
+	}
+
+bool FileStorage::write(uint32_t address, const uint8_t *data, uint16_t size) {
+	if (file == nullptr || fseek(file, address, SEEK_SET) != 0) return false;
+	return fwrite(data, 1, size, file) == size;
+	}
+
+bool FileStorage::commit() {
+	return file != nullptr && fflush(file) == 0;
+	}
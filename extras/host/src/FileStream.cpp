@@ -0,0 +1,42 @@
+#include "FileStream.h"
+
+FileStream::~FileStream() {
+	close();
+	}
+
+bool FileStream::open(const char *path, const char *mode) {
+	close();
+	file = fopen(path, mode);
+	return file != nullptr;
+	}
+
+void FileStream::close() {
+	if (file != nullptr) fclose(file);
+	file = nullptr;
+	}
+
+int FileStream::available() {
+	if (file == nullptr) return 0;
+	long position = ftell(file);
+	fseek(file, 0, SEEK_END);
+	long end = ftell(file);
+	fseek(file, position, SEEK_SET);
+	return end - position;
+	}
+
+int FileStream::read() {
+	if (file == nullptr) return -1;
+	return fgetc(file);
+	}
+
+int FileStream::peek() {
+	if (file == nullptr) return -1;
+	int c = fgetc(file);
+	if (c != EOF) ungetc(c, file);
+	return c;
+	}
+
+size_t FileStream::write(uint8_t data) {
+	if (file == nullptr) return 0;
+	return fwrite(&data, 1, 1, file);
+	}
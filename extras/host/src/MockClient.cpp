@@ -0,0 +1,65 @@
+#include "MockClient.h"
+
+int MockClient::connect(IPAddress ip, uint16_t port) {
+	(void)ip;
+	(void)port;
+	return up;
+	}
+
+int MockClient::connect(const char *host, uint16_t port) {
+	(void)host;
+	(void)port;
+	return up;
+	}
+
+size_t MockClient::write(uint8_t data) {
+	return write(&data, 1);
+	}
+
+size_t MockClient::write(const uint8_t *buffer, size_t size) {
+	if (!up) return 0;
+	written.insert(written.end(), buffer, buffer + size);
+	return size;
+	}
+
+int MockClient::available() {
+	return incoming.size();
+	}
+
+int MockClient::read() {
+	if (incoming.empty()) return -1;
+	int data = incoming.front();
+	incoming.pop_front();
+	return data;
+	}
+
+int MockClient::read(uint8_t *buffer, size_t size) {
+	size_t count = 0;
+	while (count < size && !incoming.empty()) {
+		buffer[count++] = incoming.front();
+		incoming.pop_front();
+		}
+	return count;
+	}
+
+int MockClient::peek() {
+	return incoming.empty() ? -1 : incoming.front();
+	}
+
+void MockClient::flush() {
+	}
+
+void MockClient::stop() {
+	}
+
+uint8_t MockClient::connected() {
+	return up;
+	}
+
+MockClient::operator bool() {
+	return up;
+	}
+
+void MockClient::receive(const uint8_t *data, size_t size) {
+	incoming.insert(incoming.end(), data, data + size);
+	}
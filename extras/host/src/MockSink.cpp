@@ -0,0 +1,27 @@
+#include <chrono>
+
+#include "MockSink.h"
+
+MockSink::MockSink(uint16_t channels, uint32_t byteTime) : image(channels, 0) {
+	this->byteTime = byteTime;
+	}
+
+void MockSink::write(uint16_t channel, const uint8_t *values, uint16_t count) {
+	if (channel + count > image.size()) return;
+	memcpy(image.data() + channel, values, count);
+	writes++;
+	bytes += count;
+	if (byteTime == 0) return;
+	auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds((uint64_t)byteTime * count);
+	while (std::chrono::steady_clock::now() < end) {} // busy like a blocking SPI transfer
+	}
+
+void MockSink::show() {
+	frames++;
+	}
+
+void MockSink::reset() {
+	writes = 0;
+	bytes = 0;
+	frames = 0;
+	}
@@ -0,0 +1,86 @@
+#include "MockUdp.h"
+
+uint8_t MockUdp::begin(uint16_t port) {
+	(void)port;
+	return 1;
+	}
+
+void MockUdp::stop() {
+	}
+
+int MockUdp::beginPacket(IPAddress ip, uint16_t port) {
+	(void)ip;
+	(void)port;
+	packet.clear();
+	return up;
+	}
+
+int MockUdp::beginPacket(const char *host, uint16_t port) {
+	(void)host;
+	(void)port;
+	packet.clear();
+	return up;
+	}
+
+int MockUdp::endPacket() {
+	if (!up) return 0;
+	sent.push_back(packet);
+	return 1;
+	}
+
+size_t MockUdp::write(uint8_t data) {
+	packet.push_back(data);
+	return 1;
+	}
+
+size_t MockUdp::write(const uint8_t *buffer, size_t size) {
+	packet.insert(packet.end(), buffer, buffer + size);
+	return size;
+	}
+
+int MockUdp::parsePacket() {
+	if (inbox.empty()) return 0;
+	current = inbox.front();
+	inbox.pop_front();
+	position = 0;
+	return current.size();
+	}
+
+int MockUdp::available() {
+	return current.size() - position;
+	}
+
+int MockUdp::read() {
+	if (position >= current.size()) return -1;
+	return current[position++];
+	}
+
+int MockUdp::read(unsigned char *buffer, size_t length) {
+	size_t size = 0;
+	while (size < length && position < current.size()) buffer[size++] = current[position++];
+	return size;
+	}
+
+int MockUdp::read(char *buffer, size_t length) {
+	return read((unsigned char*)buffer, length);
+	}
+
+int MockUdp::peek() {
+	if (position >= current.size()) return -1;
+	return current[position];
+	}
+
+void MockUdp::flush() {
+	}
+
+IPAddress MockUdp::remoteIP() {
+	return IPAddress(127, 0, 0, 1);
+	}
+
+uint16_t MockUdp::remotePort() {
+	return 8000;
+	}
+
+void MockUdp::receive(const uint8_t *packet, size_t size) {
+	inbox.push_back(std::vector<uint8_t>(packet, packet + size));
+	}
@@ -0,0 +1,116 @@
+#include "PosixClient.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+PosixClient::~PosixClient() {
+	stop();
+	}
+
+int PosixClient::connect(IPAddress ip, uint16_t port) {
+	stop();
+	socketHandle = socket(AF_INET, SOCK_STREAM, 0);
+	if (socketHandle < 0) return 0;
+	struct sockaddr_in remote;
+	memset(&remote, 0, sizeof(remote));
+	remote.sin_family = AF_INET;
+	remote.sin_addr.s_addr = (uint32_t)ip;
+	remote.sin_port = htons(port);
+	if (::connect(socketHandle, (struct sockaddr*)&remote, sizeof(remote)) < 0) {
+		stop();
+		return 0;
+		}
+	int noDelay = 1; // small OSC messages should not wait for Nagle
+	setsockopt(socketHandle, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+	fcntl(socketHandle, F_SETFL, fcntl(socketHandle, F_GETFL, 0) | O_NONBLOCK);
+	return 1;
+	}
+
+int PosixClient::connect(const char *host, uint16_t port) {
+	struct addrinfo hints;
+	struct addrinfo *result;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	if (getaddrinfo(host, nullptr, &hints, &result) != 0) return 0;
+	uint32_t raw = ((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+	freeaddrinfo(result);
+	return connect(IPAddress(raw), port);
+	}
+
+size_t PosixClient::write(uint8_t data) {
+	return write(&data, 1);
+	}
+
+size_t PosixClient::write(const uint8_t *buffer, size_t size) {
+	if (socketHandle < 0) return 0;
+	size_t sent = 0;
+	while (sent < size) {
+		ssize_t n = send(socketHandle, buffer + sent, size - sent, MSG_NOSIGNAL);
+		if (n > 0) sent += n;
+		else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+		else {
+			stop();
+			break;
+			}
+		}
+	return sent;
+	}
+
+int PosixClient::available() {
+	if (socketHandle < 0) return 0;
+	int size = 0;
+	if (ioctl(socketHandle, FIONREAD, &size) < 0) return 0;
+	return size;
+	}
+
+int PosixClient::read() {
+	uint8_t data;
+	if (read(&data, 1) != 1) return -1;
+	return data;
+	}
+
+int PosixClient::read(uint8_t *buffer, size_t size) {
+	if (socketHandle < 0) return -1;
+	ssize_t n = recv(socketHandle, buffer, size, 0);
+	if (n == 0) stop(); // closed by the remote side
+	if (n <= 0) return -1;
+	return n;
+	}
+
+int PosixClient::peek() {
+	if (socketHandle < 0) return -1;
+	uint8_t data;
+	if (recv(socketHandle, &data, 1, MSG_PEEK) != 1) return -1;
+	return data;
+	}
+
+void PosixClient::flush() {
+	}
+
+void PosixClient::stop() {
+	if (socketHandle >= 0) close(socketHandle);
+	socketHandle = -1;
+	}
+
+uint8_t PosixClient::connected() {
+	if (socketHandle < 0) return 0;
+	uint8_t data;
+	ssize_t n = recv(socketHandle, &data, 1, MSG_PEEK);
+	if (n == 0) { // closed by the remote side
+		stop();
+		return 0;
+		}
+	return 1;
+	}
+
+PosixClient::operator bool() {
+	return socketHandle >= 0;
+	}
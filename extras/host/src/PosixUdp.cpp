@@ -0,0 +1,132 @@
+#include "PosixUdp.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+PosixUDP::~PosixUDP() {
+	stop();
+	}
+
+bool PosixUDP::open() {
+	if (socketHandle >= 0) return true;
+	socketHandle = socket(AF_INET, SOCK_DGRAM, 0);
+	if (socketHandle < 0) return false;
+	fcntl(socketHandle, F_SETFL, fcntl(socketHandle, F_GETFL, 0) | O_NONBLOCK);
+	return true;
+	}
+
+uint8_t PosixUDP::begin(uint16_t port) {
+	if (!open()) return 0;
+	int reuse = 1;
+	setsockopt(socketHandle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	struct sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = htons(port);
+	if (bind(socketHandle, (struct sockaddr*)&local, sizeof(local)) < 0) return 0;
+	return 1;
+	}
+
+void PosixUDP::stop() {
+	if (socketHandle >= 0) close(socketHandle);
+	socketHandle = -1;
+	}
+
+int PosixUDP::beginPacket(IPAddress ip, uint16_t port) {
+	if (!open()) return 0;
+	sendIp = ip;
+	sendPort = port;
+	sendSize = 0;
+	return 1;
+	}
+
+int PosixUDP::beginPacket(const char *host, uint16_t port) {
+	struct addrinfo hints;
+	struct addrinfo *result;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	if (getaddrinfo(host, nullptr, &hints, &result) != 0) return 0;
+	uint32_t raw = ((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+	freeaddrinfo(result);
+	return beginPacket(IPAddress(raw), port);
+	}
+
+int PosixUDP::endPacket() {
+	struct sockaddr_in remote;
+	memset(&remote, 0, sizeof(remote));
+	remote.sin_family = AF_INET;
+	remote.sin_addr.s_addr = (uint32_t)sendIp;
+	remote.sin_port = htons(sendPort);
+	ssize_t sent = sendto(socketHandle, sendBuffer, sendSize, 0, (struct sockaddr*)&remote, sizeof(remote));
+	sendSize = 0;
+	return sent < 0 ? 0 : 1;
+	}
+
+size_t PosixUDP::write(uint8_t data) {
+	return write(&data, 1);
+	}
+
+size_t PosixUDP::write(const uint8_t *buffer, size_t size) {
+	if (sendSize + size > sizeof(sendBuffer)) size = sizeof(sendBuffer) - sendSize;
+	memcpy(sendBuffer + sendSize, buffer, size);
+	sendSize += size;
+	return size;
+	}
+
+int PosixUDP::parsePacket() {
+	receiveSize = 0;
+	receivePosition = 0;
+	if (socketHandle < 0) return 0;
+	struct sockaddr_in remote;
+	socklen_t remoteSize = sizeof(remote);
+	ssize_t size = recvfrom(socketHandle, receiveBuffer, sizeof(receiveBuffer), 0, (struct sockaddr*)&remote, &remoteSize);
+	if (size <= 0) return 0;
+	receiveSize = size;
+	receiveIp = IPAddress((uint32_t)remote.sin_addr.s_addr);
+	receivePort = ntohs(remote.sin_port);
+	return size;
+	}
+
+int PosixUDP::available() {
+	return receiveSize - receivePosition;
+	}
+
+int PosixUDP::read() {
+	if (receivePosition >= receiveSize) return -1;
+	return receiveBuffer[receivePosition++];
+	}
+
+int PosixUDP::read(unsigned char *buffer, size_t length) {
+	size_t size = receiveSize - receivePosition;
+	if (length < size) size = length;
+	memcpy(buffer, receiveBuffer + receivePosition, size);
+	receivePosition += size;
+	return size;
+	}
+
+int PosixUDP::read(char *buffer, size_t length) {
+	return read((unsigned char*)buffer, length);
+	}
+
+int PosixUDP::peek() {
+	if (receivePosition >= receiveSize) return -1;
+	return receiveBuffer[receivePosition];
+	}
+
+void PosixUDP::flush() {
+	receivePosition = receiveSize;
+	}
+
+IPAddress PosixUDP::remoteIP() {
+	return receiveIp;
+	}
+
+uint16_t PosixUDP::remotePort() {
+	return receivePort;
+	}
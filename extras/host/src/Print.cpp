@@ -0,0 +1,87 @@
+#include "Print.h"
+#include "Stream.h"
+#include "Arduino.h"
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+	size_t n = 0;
+	while (size--) n += write(*buffer++);
+	return n;
+	}
+
+size_t Print::print(const char string[]) {
+	return write(string);
+	}
+
+size_t Print::print(char c) {
+	return write((uint8_t)c);
+	}
+
+size_t Print::print(int number, int base) {
+	return print((long)number, base);
+	}
+
+size_t Print::print(unsigned int number, int base) {
+	return print((unsigned long)number, base);
+	}
+
+size_t Print::print(long number, int base) {
+	char buffer[24];
+	if (base == HEX) snprintf(buffer, sizeof(buffer), "%lX", number);
+	else snprintf(buffer, sizeof(buffer), "%ld", number);
+	return print(buffer);
+	}
+
+size_t Print::print(unsigned long number, int base) {
+	char buffer[24];
+	if (base == HEX) snprintf(buffer, sizeof(buffer), "%lX", number);
+	else snprintf(buffer, sizeof(buffer), "%lu", number);
+	return print(buffer);
+	}
+
+size_t Print::print(double number, int digits) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.*f", digits, number);
+	return print(buffer);
+	}
+
+size_t Print::println() {
+	return print("\r\n");
+	}
+
+size_t Print::println(const char string[]) {
+	return print(string) + println();
+	}
+
+size_t Print::println(char c) {
+	return print(c) + println();
+	}
+
+size_t Print::println(int number, int base) {
+	return print(number, base) + println();
+	}
+
+size_t Print::println(unsigned int number, int base) {
+	return print(number, base) + println();
+	}
+
+size_t Print::println(long number, int base) {
+	return print(number, base) + println();
+	}
+
+size_t Print::println(unsigned long number, int base) {
+	return print(number, base) + println();
+	}
+
+size_t Print::println(double number, int digits) {
+	return print(number, digits) + println();
+	}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+	size_t count = 0;
+	while (count < length) {
+		int c = read();
+		if (c < 0) break;
+		buffer[count++] = (uint8_t)c;
+		}
+	return count;
+	}
@@ -0,0 +1,897 @@
+// Tests of the gma3 library with mock interfaces and the manual clock of the host layer
+// usage: gma3_tests, prints the failed checks and returns 1 if a check failed
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gma3.h"
+#include "MockClient.h"
+#include "MockSink.h"
+#include "MockUdp.h"
+
+static uint32_t checks = 0;
+static uint32_t failures = 0;
+
+#define CHECK(condition) check(condition, #condition, __FILE__, __LINE__)
+
+static void check(bool condition, const char *text, const char *file, int line) {
+	checks++;
+	if (condition) return;
+	failures++;
+	printf("%s:%d: check failed: %s\n", file, line, text);
+	}
+
+// non-volatile memory in RAM
+class MemoryStorage : public SnapshotStorage {
+	public:
+		bool read(uint32_t address, uint8_t *data, uint16_t size) override {
+			if (address + size > sizeof(memory)) return false;
+			memcpy(data, memory + address, size);
+			return true;
+			}
+		bool write(uint32_t address, const uint8_t *data, uint16_t size) override {
+			if (address + size > sizeof(memory)) return false;
+			memcpy(memory + address, data, size);
+			return true;
+			}
+		uint8_t memory[1024] = {};
+	};
+
+// stream in RAM, e.g. for a recording
+class MemoryStream : public Stream {
+	public:
+		size_t write(uint8_t data) override {
+			bytes.push_back(data);
+			return 1;
+			}
+		int available() override {return bytes.size() - position;}
+		int read() override {return position < bytes.size() ? bytes[position++] : -1;}
+		int peek() override {return position < bytes.size() ? bytes[position] : -1;}
+		std::vector<uint8_t> bytes;
+		size_t position = 0;
+	};
+
+// messages encoded by the library, UDP packets and the bytes of the TCP stream
+static Gma3Buffers<OSC_STRING_SIZE + 192, 64, 0> encoder;
+static MockUdp encoderUdp;
+static MockClient encoderClient;
+
+template <typename T>
+static std::vector<uint8_t> encode(const char *pattern, T value, protocol_t protocol = UDPOSC) {
+	encoderUdp.sent.clear();
+	encoderClient.written.clear();
+	encoder.route(ROUTE_OSC, protocol);
+	encoder.oscMessage(pattern, value);
+	if (protocol == TCP) return encoderClient.written;
+	return encoderUdp.sent.empty() ? std::vector<uint8_t>() : encoderUdp.sent.back();
+	}
+
+// a packet contains the text, e.g. the address of a message in a bundle
+static bool contains(const std::vector<uint8_t> &packet, const char *text) {
+	return std::search(packet.begin(), packet.end(), text, text + strlen(text)) != packet.end();
+	}
+
+// timetag of a bundle packet
+static uint64_t bundleTimetag(const std::vector<uint8_t> &packet) {
+	if (packet.size() < 16) return 0;
+	return ((uint64_t)(uint32_t)htoi((uint8_t*)packet.data(), 8) << 32) | (uint32_t)htoi((uint8_t*)packet.data(), 12);
+	}
+
+// received messages
+static Parser *parser = nullptr;
+static uint32_t received = 0;
+static std::string receivedPattern;
+static std::string receivedString;
+static int32_t receivedInt = 0;
+
+static void receive() {
+	received++;
+	receivedPattern = parser->patternOSC();
+	receivedString = parser->stringOSC();
+	receivedInt = parser->int1OSC();
+	}
+
+static void receiveReset() {
+	received = 0;
+	receivedPattern.clear();
+	receivedString.clear();
+	receivedInt = 0;
+	}
+
+static void testParserUDP() {
+	Gma3Buffers<128, 32, 0> context; // small receive buffer, larger packets are parsed from the stream
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Parser oscParser(receive);
+	oscParser.attach(context);
+	parser = &oscParser;
+	receiveReset();
+
+	std::vector<uint8_t> packet = encode("/gma3/Page1/Fader201", 50);
+	udp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(received == 1);
+	CHECK(receivedPattern == "Page1/Fader201");
+	CHECK(receivedInt == 50);
+
+	std::string command = "Go+ Executor 201 Thru 210 At 100"; // larger than the receive buffer
+	packet = encode("/gma3/cmd", command.c_str());
+	udp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(received == 2);
+	CHECK(receivedPattern == "cmd");
+	CHECK(receivedString == command);
+
+	packet = encode("/other/Page1/Key101", 1);
+	udp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(received == 2);
+#if GMA3_STATISTICS
+	CHECK(context.statistics().packetsReceived == 3);
+	CHECK(context.statistics().oversizedReceives == 1);
+	CHECK(context.statistics().prefixRejects == 1);
+	CHECK(context.statistics().parseErrors == 0);
+#endif
+
+	// the longest string, also if OSC_STRING_SIZE exceeds 255, from the stream and from the receive buffer
+	std::string longest(OSC_STRING_SIZE - 1, 'x');
+	packet = encode("/gma3/cmd", longest.c_str());
+	udp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(receivedString == longest);
+	Gma3Buffers<128, OSC_STRING_SIZE + 32, 0> large;
+	MockUdp largeUdp;
+	large.interface(largeUdp, IPAddress(10, 0, 0, 1));
+	oscParser.attach(large);
+	receiveReset();
+	largeUdp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(receivedString == longest);
+	}
+
+static void testParserTCP() {
+	Gma3Buffers<128, 48, 0> context;
+	MockUdp udp;
+	MockClient client;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	context.interface(client, TCP, IPAddress(10, 0, 0, 1));
+	Parser oscParser(receive);
+	oscParser.attach(context);
+	parser = &oscParser;
+	receiveReset();
+
+	std::vector<uint8_t> stream;
+	const char *strings[] = {"first", "a string larger than the receive buffer of 48 bytes", "third"};
+	for (const char *string : strings) {
+		std::vector<uint8_t> message = encode("/gma3/Page1/Key101", string, TCP);
+		stream.insert(stream.end(), message.begin(), message.end());
+		}
+	std::vector<std::string> results;
+	for (size_t i = 0; i < stream.size(); i += 7) { // one TCP segment of 7 bytes per update
+		client.receive(stream.data() + i, stream.size() - i < 7 ? stream.size() - i : 7);
+		uint32_t before = received;
+		oscParser.update();
+		if (received != before) results.push_back(receivedString);
+		}
+	CHECK(results.size() == 2); // the split message larger than the receive buffer is dropped
+	if (results.size() == 2) {
+		CHECK(results[0] == strings[0]);
+		CHECK(results[1] == strings[2]);
+		}
+	CHECK(client.available() == 0);
+
+	// messages which arrive together, also a message larger than the receive buffer is parsed from the stream
+	stream.clear();
+	for (const char *string : strings) {
+		std::vector<uint8_t> message = encode("/gma3/Page1/Key101", string, TCP);
+		stream.insert(stream.end(), message.begin(), message.end());
+		}
+	client.receive(stream.data(), stream.size());
+	receiveReset();
+	oscParser.update();
+	CHECK(received == 3);
+	CHECK(receivedString == "third");
+
+	// the bytes of a raw OSC message aren't read as a size
+	const uint8_t raw[] = {'/', 'g', 'm', 'a', '3', '/', 'P', 'a', 'g', 'e', '1', '/', 'K', 'e', 'y', '1', '0', '1', 0, 0, ',', 'i', 0, 0, 0, 0, 0, 1};
+	client.receive(raw, sizeof(raw));
+	receiveReset();
+	oscParser.update();
+	CHECK(received == 1);
+	CHECK(receivedPattern == "Page1/Key101");
+	CHECK(receivedInt == 1);
+
+	// garbage and a blob with an impossible size are skipped up to the next message
+	const uint8_t garbage[] = {'x', 'y', 'z', 0, '/', 'g', 'm', 'a', '3', '/', 'X', 0, ',', 'b', 0, 0, 0x7f, 0xff, 0xff, 0xff, 1, 2, 3, 4};
+	client.receive(garbage, sizeof(garbage));
+	std::vector<uint8_t> next = encode("/gma3/Page1/Key104", "next", TCP);
+	client.receive(next.data(), next.size());
+	receiveReset();
+	oscParser.update();
+	CHECK(received == 1);
+	CHECK(receivedString == "next");
+	CHECK(client.available() == 0);
+
+	// a UDP packet waits while a partial TCP message is in the receive buffer
+	std::vector<uint8_t> message = encode("/gma3/Page1/Key102", "tcp", TCP);
+	client.receive(message.data(), 10);
+	receiveReset();
+	oscParser.update();
+	std::vector<uint8_t> packet = encode("/gma3/Page1/Key103", "udp");
+	udp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(received == 0);
+	client.receive(message.data() + 10, message.size() - 10);
+	oscParser.update();
+	CHECK(received == 1);
+	CHECK(receivedString == "tcp");
+	oscParser.update();
+	CHECK(received == 2);
+	CHECK(receivedString == "udp");
+
+	// the rest of a message which doesn't arrive doesn't block UDP
+	client.receive(message.data(), 10);
+	receiveReset();
+	oscParser.update();
+	udp.receive(packet.data(), packet.size());
+	oscParser.update();
+	CHECK(received == 0);
+	delay(TCP_PARTIAL_TIMEOUT + 1);
+	oscParser.update();
+	oscParser.update();
+	CHECK(received == 1);
+	CHECK(receivedString == "udp");
+	client.receive(message.data() + 10, message.size() - 10); // the late rest is skipped
+	client.receive(message.data(), message.size());
+	oscParser.update();
+	CHECK(received == 2);
+	CHECK(receivedString == "tcp");
+	}
+
+// UDP and TCP at once, every message type uses its own interface
+static void testRouting() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	MockClient client;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	context.interface(client, TCP, IPAddress(10, 0, 0, 1));
+	context.route(ROUTE_KEY, TCP);
+	context.route(ROUTE_COMMAND, TCP);
+	CHECK(context.route(ROUTE_FADER) == UDPOSC);
+	CHECK(context.route(ROUTE_KEY) == TCP);
+	Fader fader(201);
+	fader.attach(context);
+	Key key(101);
+	key.attach(context);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(512);
+	CHECK(udp.sent.size() == 1);
+	CHECK(client.written.empty());
+	key.update(true);
+	context.command("Go+ Executor 201");
+	CHECK(udp.sent.size() == 1);
+	std::vector<uint8_t> expected = encode("/gma3/DataPool1/Page1/Key101", BUTTON_PRESS, TCP);
+	std::vector<uint8_t> command = encode("/gma3/cmd", "Go+ Executor 201", TCP);
+	expected.insert(expected.end(), command.begin(), command.end());
+	CHECK(client.written == expected);
+
+	context.route(ROUTE_OSC, TCP); // already for the next message
+	client.written.clear();
+	context.oscMessage("/gma3/test", 1);
+	CHECK(client.written == encode("/gma3/test", 1, TCP));
+	CHECK(udp.sent.size() == 1);
+
+	// the Parser receives from both interfaces in the same update
+	Parser oscParser(receive);
+	oscParser.attach(context);
+	parser = &oscParser;
+	receiveReset();
+	std::vector<uint8_t> packet = encode("/gma3/Page1/Key101", "udp");
+	udp.receive(packet.data(), packet.size());
+	std::vector<uint8_t> message = encode("/gma3/Page1/Key102", "tcp", TCP);
+	client.receive(message.data(), message.size());
+	oscParser.update();
+	CHECK(received == 2);
+
+	// a message type without its interface uses the other one
+	Gma3Buffers<128, 64, 0> tcpOnly;
+	MockClient tcpClient;
+	tcpOnly.interface(tcpClient, TCP, IPAddress(10, 0, 0, 1));
+	CHECK(tcpOnly.route(ROUTE_FADER) == TCP);
+	tcpOnly.oscMessage("/gma3/test", 1);
+	CHECK(tcpClient.written == encode("/gma3/test", 1, TCP));
+	}
+
+static void testFilter() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Parser oscParser(receive);
+	oscParser.attach(context);
+	parser = &oscParser;
+	receiveReset();
+
+	CHECK(oscParser.filter("Page", 1, 1) == 0);
+	std::vector<uint8_t> page1 = encode("/gma3/Page1/Fader201", 10);
+	std::vector<uint8_t> page2 = encode("/gma3/Page2/Fader201", 20);
+	udp.receive(page1.data(), page1.size());
+	udp.receive(page2.data(), page2.size());
+	oscParser.update();
+	oscParser.update();
+	CHECK(received == 1);
+	CHECK(receivedInt == 10);
+
+	CHECK(oscParser.filterChange(0, "Page", 2, 2));
+	CHECK(!oscParser.filterChange(1, "Page", 2, 2));
+	udp.receive(page1.data(), page1.size());
+	udp.receive(page2.data(), page2.size());
+	oscParser.update();
+	oscParser.update();
+	CHECK(received == 2);
+	CHECK(receivedInt == 20);
+#if GMA3_STATISTICS
+	CHECK(context.statistics().filterRejects == 2);
+#endif
+	}
+
+static void testFailover() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp primary;
+	MockUdp backup;
+	MockClient tcpPrimary;
+	MockClient tcpBackup;
+	CHECK(context.destination(primary, IPAddress(10, 0, 0, 1)) == 0);
+	CHECK(context.destination(backup, IPAddress(10, 0, 0, 2), 8000, BACKUP) == 1);
+	CHECK(context.destination(tcpPrimary, IPAddress(10, 0, 0, 1)) == 2);
+	CHECK(context.destination(tcpBackup, IPAddress(10, 0, 0, 2), 9000, BACKUP) == 3);
+	context.failover(100);
+
+	context.oscMessage("/gma3/cmd", "udp");
+	CHECK(primary.sent.size() == 1);
+	CHECK(backup.sent.size() == 0);
+
+	// the health is checked per protocol, a TCP backup replaces the TCP primary while the UDP primary is healthy
+	tcpPrimary.up = false;
+	context.route(ROUTE_OSC, TCP);
+	context.oscMessage("/gma3/cmd", "tcp");
+	CHECK(tcpBackup.written.size() > 0);
+	CHECK(context.destinationHealth(0));
+	CHECK(!context.destinationHealth(2));
+
+	// no UDP packet of the console within the timeout
+	context.route(ROUTE_OSC, UDPOSC);
+	delay(150);
+	CHECK(!context.destinationHealth(0));
+	context.oscMessage("/gma3/cmd", "udp");
+	CHECK(backup.sent.size() == 1);
+	}
+
+// a Pages or Pools object of another context doesn't change the common page of the default context
+static void testPages() {
+	Gma3Buffers<128, 64, 0> section;
+	MockUdp udp;
+	section.interface(udp, IPAddress(10, 0, 0, 1));
+	Pages pagesA(1, 5, LOCAL);
+	Pages pagesB(10, 20, LOCAL);
+	pagesB.attach(section);
+	Pools poolsB(10, 20, LOCAL);
+	poolsB.attach(section);
+	CHECK(gma3.commonPage() == 1);
+	CHECK(pagesA.currentPage() == 1);
+	CHECK(gma3.commonPool() == 1);
+	CHECK(section.commonPage() == 10);
+	CHECK(section.commonPool() == 10);
+
+	Pages pagesC(3, 5, LOCAL); // the first update sets the first page in the default context
+	CHECK(gma3.commonPage() == 1);
+	pagesC.update(false, false);
+	CHECK(gma3.commonPage() == 3);
+	gma3.commonPage(4);
+	pagesC.update(true, false);
+	CHECK(gma3.commonPage() == 5);
+	gma3.commonPage(1);
+	CHECK(udp.sent.empty());
+	}
+
+// a page change sends the values of the unlocked faders of the common page in one bundle
+static void testResync() {
+	Gma3Buffers<128, 64, 256> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Fader fader201(201);
+	Fader fader202(202);
+	Fader fader203(203);
+	Fader fader204(204);
+	fader201.attach(context);
+	fader202.attach(context);
+	fader203.attach(context);
+	fader204.attach(context);
+	fader203.page(1); // a fixed page isn't changed
+	Pages pages(1, 4, LOCAL);
+	pages.attach(context);
+	pages.resync(true);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader201.update(512);
+	fader202.update(1023);
+	fader203.update(512);
+	fader204.update(512);
+	fader204.lock(true);
+	udp.sent.clear();
+
+	pages.update(true, false);
+	CHECK(context.commonPage() == 2);
+	CHECK(udp.sent.size() == 1);
+	if (udp.sent.size() == 1) {
+		const std::vector<uint8_t> &bundle = udp.sent[0];
+		CHECK(contains(bundle, "#bundle"));
+		CHECK(contains(bundle, "Page2/Fader201"));
+		CHECK(contains(bundle, "Page2/Fader202"));
+		CHECK(!contains(bundle, "Fader203"));
+		CHECK(!contains(bundle, "Fader204"));
+		}
+	pages.update(false, false);
+	pages.resync(false);
+	udp.sent.clear();
+	pages.update(true, false);
+	CHECK(udp.sent.empty());
+	}
+
+// page and pool changes as command line or as OSC address with an integer argument
+static void testAddressMode() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Pages pages(1, 4, GLOBAL);
+	pages.attach(context);
+	Pools pools(1, 4, CONSOLE);
+	pools.attach(context);
+	pages.update(true, false);
+	pools.update(true, false);
+	CHECK(udp.sent.size() == 2);
+	CHECK(udp.sent.size() == 2 && udp.sent[0] == encode("/gma3/cmd", "Page 2"));
+	CHECK(udp.sent.size() == 2 && udp.sent[1] == encode("/gma3/cmd", "dataPool 2"));
+
+	pages.address("Page");
+	pools.address("DataPool");
+	pages.update(false, false);
+	pools.update(false, false);
+	pages.update(true, false);
+	pools.update(true, false);
+	CHECK(udp.sent.size() == 4);
+	CHECK(udp.sent.size() == 4 && udp.sent[2] == encode("/gma3/Page", 3));
+	CHECK(udp.sent.size() == 4 && udp.sent[3] == encode("/gma3/DataPool", 3));
+
+	Pages local(1, 4, LOCAL); // only used in the sketch
+	local.attach(context);
+	local.update(true, false);
+	CHECK(udp.sent.size() == 4);
+	}
+
+static void testControls() {
+	Gma3Buffers<128, 64, 0> context;
+	uint16_t empty = context.snapshotSize();
+	{
+		Fader fader(201);
+		fader.attach(context);
+		Key key(101);
+		key.attach(context);
+		CHECK(context.snapshotSize() > empty);
+		Fader copy(fader); // a copy is a control of its own
+		CHECK(copy.value() == fader.value());
+		}
+	CHECK(context.snapshotSize() == empty); // destroyed controls are removed from the context
+	}
+
+// lower scan rate after a quiet period, woken by wake(), sent and received packets
+static void testIdle() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Parser oscParser(receive);
+	oscParser.attach(context);
+	parser = &oscParser;
+	receiveReset();
+	context.idle(1000, 50);
+	CHECK(context.scanning());
+	delay(500);
+	context.update();
+	CHECK(context.scanning());
+	delay(501);
+	context.update(); // the first idle scan
+	CHECK(context.scanning());
+	context.update();
+	CHECK(!context.scanning());
+
+	std::vector<uint8_t> packet = encode("/gma3/Page1/Key101", 1);
+	udp.receive(packet.data(), packet.size());
+	oscParser.update(); // not read between the idle scans
+	CHECK(received == 0);
+	delay(50);
+	context.update();
+	CHECK(context.scanning());
+	oscParser.update();
+	CHECK(received == 1);
+	context.update(); // active again after a received packet
+	CHECK(context.scanning());
+
+	delay(1001);
+	context.update();
+	context.update();
+	CHECK(!context.scanning());
+	context.wake();
+	CHECK(context.scanning()); // immediately, without waiting for update()
+	context.update();
+	context.update();
+	CHECK(context.scanning());
+
+	delay(1001);
+	context.update();
+	context.update();
+	CHECK(!context.scanning());
+	context.oscMessage("/gma3/test", 1); // a sent packet is activity
+	CHECK(context.scanning());
+	context.idle(0);
+	}
+
+// bundles with timetags derived from millis(), larger bundles are split with the same timetag
+static void testBundles() {
+	Gma3Buffers<128, 64, 80> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	CHECK(context.timetag(millis()) == TIMETAG_IMMEDIATE); // clock offset not set
+	context.bundleBegin();
+	context.oscMessage("/gma3/Page1/Key101", 1);
+	context.oscMessage("/gma3/Page1/Key102", 1);
+	CHECK(udp.sent.empty());
+	context.bundleEnd();
+	CHECK(udp.sent.size() == 1);
+	if (udp.sent.size() == 1) {
+		CHECK(contains(udp.sent[0], "#bundle"));
+		CHECK(bundleTimetag(udp.sent[0]) == TIMETAG_IMMEDIATE);
+		CHECK(contains(udp.sent[0], "Key101"));
+		CHECK(contains(udp.sent[0], "Key102"));
+		}
+
+	context.clockOffsetUnix(1700000000, 500);
+	uint64_t now = ((uint64_t)(1700000000UL + TIMETAG_UNIX_OFFSET) << 32) | 0x80000000UL;
+	CHECK(context.timetag(millis()) == now);
+	CHECK(context.timetag(millis() + 250) == now + 0x40000000UL);
+	udp.sent.clear();
+	context.bundleBegin(context.timetag(millis() + 250));
+	context.oscMessage("/gma3/Page1/Key101", 1);
+	context.oscMessage("/gma3/Page1/Key102", 1);
+	context.oscMessage("/gma3/Page1/Key103", 1); // larger than one bundle packet
+	context.bundleEnd();
+	CHECK(udp.sent.size() == 2);
+	for (const std::vector<uint8_t> &packet : udp.sent) {
+		CHECK(packet.size() <= 80);
+		CHECK(contains(packet, "#bundle"));
+		CHECK(bundleTimetag(packet) == now + 0x40000000UL);
+		}
+	CHECK(udp.sent.size() == 2 && contains(udp.sent[1], "Key103"));
+
+	// without bundle buffer the messages are sent one by one
+	Gma3Buffers<128, 64, 0> single;
+	MockUdp singleUdp;
+	single.interface(singleUdp, IPAddress(10, 0, 0, 1));
+	single.bundleBegin();
+	single.oscMessage("/gma3/Page1/Key101", 1);
+	single.oscMessage("/gma3/Page1/Key102", 1);
+	single.bundleEnd();
+	CHECK(singleUdp.sent.size() == 2);
+	CHECK(singleUdp.sent.size() == 2 && singleUdp.sent[0] == encode("/gma3/Page1/Key101", 1));
+	}
+
+// executor feedback to indicator channels, only changed channels are written once per frame
+static IndicatorOutput *indicatorOutput = nullptr;
+
+static void indicatorFeed() {
+	indicatorOutput->feed(*parser);
+	}
+
+static void testIndicators() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	MockSink sink(16);
+	Indicators<16> indicators(sink);
+	indicatorOutput = &indicators;
+	Parser oscParser(indicatorFeed);
+	oscParser.attach(context);
+	parser = &oscParser;
+	CHECK(indicators.assign(201, 0) >= 0);
+	CHECK(indicators.assign(201, 9) >= 0);
+	CHECK(indicators.assign(202, 1, INDICATOR_LEVEL, nullptr, 200, 0) >= 0);
+	CHECK(indicators.assign(203, 16) == -1); // the channel doesn't exist
+
+	std::vector<uint8_t> state = encode("/gma3/13.13.1.5.201", 1);
+	std::vector<uint8_t> level = encode("/gma3/13.13.1.5.202", 50.0f);
+	udp.receive(state.data(), state.size());
+	udp.receive(level.data(), level.size());
+	oscParser.update();
+	oscParser.update();
+	CHECK(indicators.get(0) == 255);
+	CHECK(indicators.get(1) == 100);
+	CHECK(sink.frames == 0); // with the next frame
+	indicators.update();
+	CHECK(sink.frames == 1);
+	CHECK(sink.writes == 2); // channels 0 to 1 and channel 9
+	CHECK(sink.bytes == 3);
+	CHECK(sink.image[0] == 255 && sink.image[1] == 100 && sink.image[9] == 255);
+
+	udp.receive(state.data(), state.size()); // unchanged
+	oscParser.update();
+	delay(INDICATOR_FRAME_MS);
+	indicators.update();
+	CHECK(sink.frames == 1);
+
+	std::vector<uint8_t> off = encode("/gma3/13.13.1.5.201", 0);
+	udp.receive(off.data(), off.size());
+	oscParser.update();
+	indicators.update();
+	CHECK(sink.frames == 2);
+	CHECK(sink.image[0] == 0 && sink.image[9] == 0);
+	udp.receive(state.data(), state.size());
+	oscParser.update();
+	indicators.update(); // the next frame isn't due
+	CHECK(sink.frames == 2);
+	delay(INDICATOR_FRAME_MS);
+	indicators.update();
+	CHECK(sink.frames == 3);
+	CHECK(sink.image[0] == 255);
+
+	sink.reset();
+	indicators.refresh();
+	delay(INDICATOR_FRAME_MS);
+	indicators.update();
+	CHECK(sink.writes == 1);
+	CHECK(sink.bytes == 16);
+	}
+
+static void testSnapshot() {
+	Gma3Buffers<128, 64, 256> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Fader fader201(201);
+	Fader fader202(202);
+	fader201.attach(context);
+	fader202.attach(context);
+	MemoryStorage storage;
+
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader201.update(512);
+	fader202.update(1023);
+	int32_t value201 = fader201.value();
+	int32_t value202 = fader202.value();
+	context.commonPage(3);
+	CHECK(context.snapshotSave(storage));
+
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader201.update(0);
+	fader202.update(0);
+	context.commonPage(1);
+	CHECK(fader201.value() != value201);
+	udp.sent.clear();
+	CHECK(context.snapshotRecall(storage));
+	CHECK(fader201.value() == value201);
+	CHECK(fader202.value() == value202);
+	CHECK(context.commonPage() == 3);
+	CHECK(udp.sent.size() == 1); // both values in one bundle
+
+	// a changed byte fails the CRC check, nothing is changed
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader201.update(1023);
+	storage.memory[SNAPSHOT_HEADER_SIZE + 8] ^= 0x01;
+	udp.sent.clear();
+	CHECK(!context.snapshotRecall(storage));
+	CHECK(fader201.value() != value201);
+	CHECK(udp.sent.size() == 0);
+	CHECK(!context.snapshotRecall(storage, 512)); // no snapshot
+	}
+
+static void testRecorder() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Fader fader(201);
+	fader.attach(context);
+	uint8_t arena[64];
+	uint8_t playArena[64];
+	Recorder recorder(arena, sizeof(arena));
+	Recorder player(playArena, sizeof(playArena));
+	recorder.attach(context);
+	player.attach(context);
+
+	CHECK(recorder.record());
+	CHECK(!player.record()); // one recording per context
+	for (uint16_t value = 100; value <= 1000; value += 100) {
+		delay(FADER_UPDATE_RATE_MS + 1);
+		fader.update(value);
+		}
+	recorder.stop();
+	int32_t recordedValue = fader.value();
+	CHECK(udp.sent.size() == 10);
+	CHECK(recorder.size() > 0);
+	CHECK(recorder.size() < 10 * 4); // a few bytes per event
+	CHECK(recorder.duration() >= 9 * (FADER_UPDATE_RATE_MS + 1));
+
+	MemoryStream stream;
+	CHECK(recorder.save(stream) == stream.bytes.size());
+	CHECK(player.load(stream));
+	CHECK(player.size() == recorder.size());
+	CHECK(player.duration() == recorder.duration());
+
+	std::vector<std::vector<uint8_t>> recorded = udp.sent;
+	udp.sent.clear();
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(0); // moved away before the playback
+	udp.sent.clear();
+	player.play();
+	for (uint32_t time = 0; player.playing() && time < 2000; time++) {
+		player.update();
+		delay(1);
+		}
+	CHECK(!player.playing());
+	CHECK(udp.sent == recorded);
+	CHECK(fader.value() == recordedValue);
+
+	// a corrupt header is rejected
+	stream.bytes[0] = 'x';
+	stream.position = 0;
+	CHECK(!player.load(stream));
+
+	// the recording stops when the arena is full
+	Recorder small(arena, 8);
+	small.attach(context);
+	CHECK(small.record());
+	for (uint16_t value = 100; value <= 1000; value += 100) {
+		delay(FADER_UPDATE_RATE_MS + 1);
+		fader.update(value);
+		}
+	CHECK(small.full());
+	CHECK(!small.recording());
+	}
+
+#if GMA3_RATE_LIMIT
+static void testRateLimit() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	Fader fader(201);
+	fader.attach(context);
+	Key key(101);
+	key.attach(context);
+	context.rateLimit(ROUTE_FADER, 2, 1); // a message every 500ms
+
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(200);
+	CHECK(udp.sent.size() == 1);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(800);
+	CHECK(udp.sent.size() == 1); // deferred
+	CHECK(context.rateState(ROUTE_FADER).throttled == 1);
+	delay(500);
+	fader.update(800);
+	CHECK(udp.sent.size() == 2); // the latest value
+	CHECK(fader.value() > 70);
+
+	// keys have priority and overdraw the global bucket
+	context.rateLimit(2, 1);
+	for (uint8_t i = 0; i < 4; i++) key.update(i % 2 == 0);
+	CHECK(udp.sent.size() == 6);
+	CHECK(context.rateState().tokens < 0);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(200);
+	CHECK(udp.sent.size() == 6); // faders wait until the debt is paid
+	delay(2000);
+	fader.update(200);
+	CHECK(udp.sent.size() == 7);
+
+	context.rateLimit(0);
+	context.rateLimit(ROUTE_FADER, 0);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(800);
+	delay(FADER_UPDATE_RATE_MS + 1);
+	fader.update(200);
+	CHECK(udp.sent.size() == 9);
+	}
+#endif
+
+#if GMA3_MERGE
+static void testMerge() {
+	Gma3Buffers<128, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	context.commandMerge(true);
+	context.command("Go+ Executor 201");
+	context.command("Go+ Executor 202");
+	CHECK(udp.sent.size() == 0);
+	context.update();
+	CHECK(udp.sent.size() == 1);
+	std::vector<uint8_t> expected = encode("/gma3/cmd", "Go+ Executor 201; Go+ Executor 202");
+	CHECK(udp.sent.size() == 1 && udp.sent[0] == expected);
+	context.command("Off Executor 201");
+	context.commandMerge(false); // sends the pending commands
+	CHECK(udp.sent.size() == 2);
+	context.command("Off Executor 202");
+	CHECK(udp.sent.size() == 3);
+
+	// the merged commands keep their route, the message which flushes them keeps its own
+	MockClient client;
+	context.interface(client, TCP, IPAddress(10, 0, 0, 1));
+	context.route(ROUTE_KEY, TCP);
+	Key key(101);
+	key.attach(context);
+	context.commandMerge(true);
+	context.command("Go+ Executor 201");
+	key.update(true);
+	CHECK(udp.sent.size() == 4);
+	CHECK(udp.sent.size() == 4 && udp.sent[3] == encode("/gma3/cmd", "Go+ Executor 201"));
+	CHECK(client.written == encode("/gma3/DataPool1/Page1/Key101", BUTTON_PRESS, TCP));
+	}
+#endif
+
+#if GMA3_MACROS
+static void testMacros() {
+	Gma3Buffers<OSC_STRING_SIZE + 64, 64, 0> context;
+	MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	CmdButton button("Go+ Executor 201\n#100\nGo+ Executor 202");
+	button.attach(context);
+	button.update(true);
+	CHECK(udp.sent.size() == 1); // the first step without delay
+	delay(50);
+	context.update();
+	CHECK(udp.sent.size() == 1);
+	delay(50);
+	context.update();
+	CHECK(udp.sent.size() == 2);
+	CHECK(udp.sent.size() == 2 && udp.sent[1] == encode("/gma3/cmd", "Go+ Executor 202"));
+	context.update();
+	CHECK(udp.sent.size() == 2);
+
+	CHECK(context.macro("Go+ Executor 203\n#1000\nGo+ Executor 204"));
+	context.macroStop();
+	delay(1000);
+	context.update();
+	CHECK(udp.sent.size() == 3);
+
+	std::string longest(OSC_STRING_SIZE - 1, 'x'); // a step of the full string size, also if it exceeds 255
+	CHECK(context.macro(longest.c_str()));
+	context.update();
+	CHECK(udp.sent.back() == encode("/gma3/cmd", longest.c_str()));
+	}
+#endif
+
+int main() {
+	hostTime(1000000); // the manual clock makes the timing deterministic
+	encoder.interface(encoderUdp, IPAddress(10, 0, 0, 1));
+	encoder.interface(encoderClient, TCP, IPAddress(10, 0, 0, 1));
+	testParserUDP();
+	testParserTCP();
+	testRouting();
+	testFilter();
+	testFailover();
+	testPages();
+	testResync();
+	testAddressMode();
+	testControls();
+	testIdle();
+	testBundles();
+	testIndicators();
+	testSnapshot();
+	testRecorder();
+#if GMA3_RATE_LIMIT
+	testRateLimit();
+#endif
+#if GMA3_MERGE
+	testMerge();
+#endif
+#if GMA3_MACROS
+	testMacros();
+#endif
+	printf("%u checks, %u failed\n", checks, failures);
+	return failures == 0 ? 0 : 1;
+	}
@@ -0,0 +1,84 @@
+// Tests of the packet queue of the threaded mode, an input thread sends and a network thread transmits
+// usage: gma3_queue_tests, prints the failed checks and returns 1 if a check failed
+
+#include <atomic>
+#include <thread>
+
+#include "gma3.h"
+#include "MockUdp.h"
+
+static uint32_t checks = 0;
+static uint32_t failures = 0;
+
+#define CHECK(condition) check(condition, #condition, __FILE__, __LINE__)
+
+static void check(bool condition, const char *text, const char *file, int line) {
+	checks++;
+	if (condition) return;
+	failures++;
+	printf("%s:%d: check failed: %s\n", file, line, text);
+	}
+
+static int32_t packetValue(const std::vector<uint8_t> &packet) {
+	return packet.size() >= 4 ? htoi((uint8_t*)packet.data(), packet.size() - 4) : -1;
+	}
+
+// the packets arrive in order while both threads run
+static void testThreads() {
+	static Gma3Buffers<64, 64, 0> context;
+	static MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	context.threaded(true);
+	const int32_t count = 20000;
+	std::atomic<bool> done{false};
+	std::thread network([&]() {
+		while (!done) context.transmit();
+		context.transmit();
+		});
+	for (int32_t i = 0; i < count; i++) {
+		context.oscMessage("/gma3/Page1/Fader201", i);
+		if (i % 8 == 0) std::this_thread::yield();
+		}
+	done = true;
+	network.join();
+	bool ordered = true; // packets can be dropped if the network thread is late, but not reordered
+	for (size_t i = 1; i < udp.sent.size(); i++) {
+		if (packetValue(udp.sent[i]) <= packetValue(udp.sent[i - 1])) ordered = false;
+		}
+	CHECK(ordered);
+	CHECK(udp.sent.size() > 0);
+#if GMA3_STATISTICS
+	CHECK(udp.sent.size() + context.statistics().queueDrops == (size_t)count);
+#endif
+	context.threaded(false);
+	}
+
+// a full queue drops the new packets, the queued packets are kept
+static void testOverflow() {
+	static Gma3Buffers<64, 64, 0> context;
+	static MockUdp udp;
+	context.interface(udp, IPAddress(10, 0, 0, 1));
+	context.threaded(true);
+	const int32_t count = OSC_QUEUE_SIZE / 8;
+	for (int32_t i = 0; i < count; i++) context.oscMessage("/gma3/Page1/Fader201", i);
+	CHECK(udp.sent.size() == 0);
+	context.transmit();
+	CHECK(udp.sent.size() > 0);
+	CHECK(udp.sent.size() < (size_t)count);
+	for (size_t i = 0; i < udp.sent.size(); i++) CHECK(packetValue(udp.sent[i]) == (int32_t)i);
+#if GMA3_STATISTICS
+	CHECK(udp.sent.size() + context.statistics().queueDrops == (size_t)count);
+#endif
+	udp.sent.clear();
+	context.oscMessage("/gma3/Page1/Fader201", count); // space again
+	context.transmit();
+	CHECK(udp.sent.size() == 1);
+	context.threaded(false);
+	}
+
+int main() {
+	testThreads();
+	testOverflow();
+	printf("%u checks, %u failed\n", checks, failures);
+	return failures == 0 ? 0 : 1;
+	}
@@ -0,0 +1,76 @@
+// Latency report for the histograms printed by Gma3::latencyPrint()
+// usage: gma3_latency_report < serial.log
+// the last histogram of each type is used, other lines are ignored
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define LATENCY_BUCKETS 16
+#define TYPES_MAX 8
+
+struct Histogram {
+	char name[32];
+	uint32_t max;
+	uint32_t buckets[LATENCY_BUCKETS];
+	};
+
+static Histogram histograms[TYPES_MAX];
+static int histogramCount = 0;
+
+static Histogram* histogram(const char *name) {
+	for (int i = 0; i < histogramCount; i++) {
+		if (strcmp(histograms[i].name, name) == 0) return &histograms[i];
+		}
+	if (histogramCount == TYPES_MAX) return nullptr;
+	Histogram *histogram = &histograms[histogramCount++];
+	strncpy(histogram->name, name, sizeof(histogram->name) - 1);
+	return histogram;
+	}
+
+// upper bound of the bucket which contains the percentile
+static uint32_t percentile(const Histogram &histogram, uint64_t count, double percent) {
+	uint64_t rank = (uint64_t)(count * percent / 100.0 + 0.5);
+	if (rank == 0) rank = 1;
+	uint64_t sum = 0;
+	for (int i = 0; i < LATENCY_BUCKETS; i++) {
+		sum += histogram.buckets[i];
+		if (sum >= rank) {
+			uint32_t bound = (2UL << i) - 1;
+			return bound < histogram.max ? bound : histogram.max;
+			}
+		}
+	return histogram.max;
+	}
+
+int main() {
+	char line[512];
+	while (fgets(line, sizeof(line), stdin) != nullptr) {
+		char *token = strtok(line, " \t\r\n");
+		if (token == nullptr || strcmp(token, "latency") != 0) continue;
+		char *name = strtok(nullptr, " \t\r\n");
+		char *max = strtok(nullptr, " \t\r\n");
+		if (name == nullptr || max == nullptr) continue;
+		Histogram *target = histogram(name);
+		if (target == nullptr) continue;
+		target->max = strtoul(max, nullptr, 10);
+		for (int i = 0; i < LATENCY_BUCKETS; i++) {
+			char *value = strtok(nullptr, " \t\r\n");
+			target->buckets[i] = value != nullptr ? strtoul(value, nullptr, 10) : 0;
+			}
+		}
+	printf("%-14s %10s %10s %10s %10s %10s %10s\n", "type", "count", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+	for (int i = 0; i < histogramCount; i++) {
+		const Histogram &h = histograms[i];
+		uint64_t count = 0;
+		for (int b = 0; b < LATENCY_BUCKETS; b++) count += h.buckets[b];
+		if (count == 0) {
+			printf("%-14s %10d %10s %10s %10s %10s %10s\n", h.name, 0, "-", "-", "-", "-", "-");
+			continue;
+			}
+		printf("%-14s %10llu %10u %10u %10u %10u %10u\n", h.name, (unsigned long long)count,
+			percentile(h, count, 50), percentile(h, count, 90), percentile(h, count, 99), percentile(h, count, 99.9), h.max);
+		}
+	return 0;
+	}
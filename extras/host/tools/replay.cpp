@@ -0,0 +1,195 @@
+// Replay of a traffic capture written by Gma3::capture()
+// usage: gma3_replay <capture> [-s speed] [-n passes] [-a] [-u host:port | -t host:port]
+// -s speed factor, 1 is realtime, 0 as fast as possible, default 1
+// -n number of passes through the capture, default 1
+// -a replay also the sent packets, default only the received packets
+// -u, -t send the packets via UDP or TCP instead of feeding the Parser
+
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gma3.h"
+#include "PosixUdp.h"
+#include "PosixClient.h"
+
+struct Frame {
+	uint32_t time; // us
+	uint8_t flags;
+	std::vector<uint8_t> packet;
+	};
+
+// UDP source for the Parser which returns the packet of the current frame once
+class ReplayUDP : public UDP {
+	public:
+		void push(const Frame &frame) {
+			current = &frame;
+			pending = true;
+			position = 0;
+			}
+		uint8_t begin(uint16_t port) override {(void)port; return 1;}
+		void stop() override {}
+		int beginPacket(IPAddress ip, uint16_t port) override {(void)ip; (void)port; return 1;}
+		int beginPacket(const char *host, uint16_t port) override {(void)host; (void)port; return 1;}
+		int endPacket() override {return 1;}
+		size_t write(uint8_t data) override {(void)data; return 1;}
+		size_t write(const uint8_t *buffer, size_t size) override {(void)buffer; return size;}
+		int parsePacket() override {
+			if (!pending) return 0;
+			pending = false;
+			return current->packet.size();
+			}
+		int available() override {return current->packet.size() - position;}
+		int read() override {return position < current->packet.size() ? current->packet[position++] : -1;}
+		int read(unsigned char *buffer, size_t length) override {
+			size_t size = current->packet.size() - position;
+			if (length < size) size = length;
+			memcpy(buffer, current->packet.data() + position, size);
+			position += size;
+			return size;
+			}
+		int read(char *buffer, size_t length) override {return read((unsigned char*)buffer, length);}
+		int peek() override {return position < current->packet.size() ? current->packet[position] : -1;}
+		void flush() override {}
+		IPAddress remoteIP() override {return IPAddress(127, 0, 0, 1);}
+		uint16_t remotePort() override {return 8000;}
+
+	private:
+		const Frame *current = nullptr;
+		bool pending = false;
+		size_t position = 0;
+	};
+
+static bool load(const char *path, std::vector<Frame> &frames) {
+	FILE *file = fopen(path, "rb");
+	if (file == nullptr) return false;
+	uint8_t header[sizeof(CAPTURE_HEADER)];
+	if (fread(header, 1, sizeof(header), file) != sizeof(header)
+		|| memcmp(header, CAPTURE_HEADER, sizeof(CAPTURE_HEADER) - 1) != 0 || header[sizeof(header) - 1] != CAPTURE_VERSION) {
+		fclose(file);
+		return false;
+		}
+	uint8_t data[7];
+	while (fread(data, 1, sizeof(data), file) == sizeof(data)) {
+		Frame frame;
+		frame.time = (uint32_t)htoi(data, 0);
+		frame.flags = data[4];
+		frame.packet.resize((data[5] << 8) | data[6]);
+		if (fread(frame.packet.data(), 1, frame.packet.size(), file) != frame.packet.size()) break; // truncated capture
+		frames.push_back(frame);
+		}
+	fclose(file);
+	return true;
+	}
+
+static bool address(const char *argument, IPAddress &ip, uint16_t &port) {
+	char host[64];
+	strncpy(host, argument, sizeof(host) - 1);
+	host[sizeof(host) - 1] = 0;
+	char *separator = strchr(host, ':');
+	if (separator == nullptr) return false;
+	*separator = 0;
+	port = atoi(separator + 1);
+	int a, b, c, d;
+	if (sscanf(host, "%d.%d.%d.%d", &a, &b, &c, &d) != 4) return false;
+	ip = IPAddress(a, b, c, d);
+	return true;
+	}
+
+ReplayUDP replay;
+PosixUDP udp;
+PosixClient tcp;
+uint32_t messages = 0;
+
+void parse() {
+	messages++;
+	}
+
+Parser parser(parse);
+
+int main(int argc, char *argv[]) {
+	double speed = 1.0;
+	uint32_t passes = 1;
+	bool all = false;
+	protocol_t protocol = UDPOSC;
+	bool transport = false;
+	IPAddress ip;
+	uint16_t port = 0;
+	int option;
+	while ((option = getopt(argc, argv, "s:n:au:t:")) != -1) {
+		switch (option) {
+			case 's': speed = atof(optarg); break;
+			case 'n': passes = strtoul(optarg, nullptr, 10); break;
+			case 'a': all = true; break;
+			case 'u':
+			case 't':
+				if (!address(optarg, ip, port)) {
+					fprintf(stderr, "invalid address %s, use ip:port\n", optarg);
+					return 1;
+					}
+				transport = true;
+				protocol = option == 't' ? TCP : UDPOSC;
+				break;
+			default:
+				fprintf(stderr, "usage: %s <capture> [-s speed] [-n passes] [-a] [-u host:port | -t host:port]\n", argv[0]);
+				return 1;
+			}
+		}
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s <capture> [-s speed] [-n passes] [-a] [-u host:port | -t host:port]\n", argv[0]);
+		return 1;
+		}
+	std::vector<Frame> frames;
+	if (!load(argv[optind], frames)) {
+		fprintf(stderr, "can't read capture %s\n", argv[optind]);
+		return 1;
+		}
+	if (frames.empty()) return 0;
+
+	if (!transport) interface(replay, IPAddress(127, 0, 0, 1), 8000);
+	else if (protocol == TCP && !tcp.connect(ip, port)) {
+		fprintf(stderr, "can't connect to port %u\n", port);
+		return 1;
+		}
+
+	uint32_t packets = 0;
+	uint64_t bytes = 0;
+	uint32_t start = micros();
+	for (uint32_t pass = 0; pass < passes; pass++) {
+		uint32_t passStart = micros();
+		for (const Frame &frame : frames) {
+			if (!all && !(frame.flags & CAPTURE_RECEIVED)) continue;
+			if (speed > 0) {
+				uint32_t due = (uint32_t)((frame.time - frames[0].time) / speed);
+				uint32_t elapsed = micros() - passStart;
+				if (due > elapsed) delayMicroseconds(due - elapsed);
+				}
+			if (transport) {
+				switch (protocol) {
+					case UDPOSC:
+						udp.beginPacket(ip, port);
+						udp.write(frame.packet.data(), frame.packet.size());
+						udp.endPacket();
+						break;
+					case TCP:
+						tcp.write(frame.packet.data(), frame.packet.size());
+						break;
+					}
+				}
+			else {
+				replay.push(frame);
+				parser.update();
+				}
+			packets++;
+			bytes += frame.packet.size();
+			}
+		}
+	double seconds = (micros() - start) / 1e6;
+	printf("frames %zu, replayed %u packets, %llu bytes in %.3f s, %.0f packets/s\n",
+		frames.size(), packets, (unsigned long long)bytes, seconds, seconds > 0 ? packets / seconds : 0.0);
+	if (!transport) {
+		const struct Statistics &stats = statistics();
+		printf("parsed %u messages, prefix rejects %u, parse errors %u, oversized %u\n", messages, stats.prefixRejects, stats.parseErrors, stats.oversizedReceives);
+		}
+	return 0;
+	}
@@ -1,132 +1,1311 @@
 #include "gma3.h"
 
-// internal structs
-struct Message receiveMessage, sendMessage;
-
-// network IP address
-IPAddress ipGma3;
-
-// network sockets
-UDP *udpGma3;
-Client *tcpGma3;
-
-// network ports
-uint16_t portUdpGma3;
-uint16_t portTcpGma3;
-
-// global variables
-uint16_t pageCommon = 1;
-uint16_t poolCommon = 1;
-char namePrefix[NAME_LENGTH_MAX] = "gma3";
-char namePrefixSearch[NAME_LENGTH_MAX] = "/gma3/";
-char namePool[NAME_LENGTH_MAX] = "DataPool"; // Page name
-char namePage[NAME_LENGTH_MAX] = "Page"; // Page name
-char nameFader[NAME_LENGTH_MAX] = "Fader"; // Fader name
-char nameExecutorKnob[NAME_LENGTH_MAX] = "Encoder"; // ExecutorKnob name
-char nameKey[NAME_LENGTH_MAX] = "Key"; // Key name
+// default names in flash memory
+const char nameDefaultPrefix[] PROGMEM = GMA3_PREFIX_NAME;
+const char nameDefaultPool[] PROGMEM = GMA3_POOL_NAME;
+const char nameDefaultPage[] PROGMEM = GMA3_PAGE_NAME;
+const char nameDefaultFader[] PROGMEM = GMA3_FADER_NAME;
+const char nameDefaultExecutorKnob[] PROGMEM = GMA3_EXECUTOR_KNOB_NAME;
+const char nameDefaultKey[] PROGMEM = GMA3_KEY_NAME;
+
+// default context used by the global functions and all objects
+Gma3 gma3;
+
+// feature flags of the library, the sketch references the symbol of its flags
+const uint8_t GMA3_FEATURES = 0;
+
+#if GMA3_PROFILE
+// cycle counter of the profiler
+#if defined(GMA3_HOST)
+#include <time.h>
+#define PROFILE_TICKS_PER_US 1000
+
+static inline uint32_t profileTicks() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+	}
+#elif (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)) && defined(F_CPU)
+#define PROFILE_DEMCR      (*(volatile uint32_t*)0xE000EDFC)
+#define PROFILE_DWT_CTRL   (*(volatile uint32_t*)0xE0001000)
+#define PROFILE_DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+#define PROFILE_DWT
+#define PROFILE_TICKS_PER_US (F_CPU / 1000000)
+
+static inline uint32_t profileTicks() {
+	return PROFILE_DWT_CYCCNT;
+	}
+#else
+#define PROFILE_TICKS_PER_US 1
+
+static inline uint32_t profileTicks() {
+	return micros();
+	}
+#endif
+
+/**
+ * @brief Measures the time of a scope for a subsystem and a registered control
+ * 
+ */
+class ProfileScope {
+	public:
+		ProfileScope(Gma3Context *context, profile_t subsystem, const void *control) {
+			if (!context->profileActive) return;
+			this->context = context;
+			this->subsystem = subsystem;
+			for (uint8_t i = PROFILE_SUBSYSTEMS; control != nullptr && i < PROFILE_SUBSYSTEMS + context->profileControls; i++) {
+				if (context->profileEntries[i].control == control) this->control = i;
+				}
+			start = profileTicks();
+			}
+		~ProfileScope() {
+			if (context == nullptr) return;
+			uint32_t ticks = profileTicks() - start;
+			add(context->profileEntries[subsystem], ticks);
+			if (control != 0) add(context->profileEntries[control], ticks);
+			}
 
-void prefixName(const char *prefix) {
-	memset(namePrefix, 0, NAME_LENGTH_MAX);
-	strcpy(namePrefix, prefix);
-	memset(namePrefixSearch, 0, NAME_LENGTH_MAX);
-	if (strlen(prefix) != 0) {
-		strcpy(namePrefixSearch, "/");
-		strcat(namePrefixSearch, prefix);
-		strcat(namePrefixSearch, "/");
+	private:
+		static void add(struct Profile &entry, uint32_t ticks) {
+			entry.calls++;
+			entry.total += ticks;
+			if (ticks > entry.max) entry.max = ticks;
+			}
+		Gma3Context *context = nullptr; // nullptr if the profiler is stopped
+		profile_t subsystem = PROFILE_PARSER;
+		uint8_t control = 0; // index of the registered control, 0 if not registered
+		uint32_t start = 0;
+	};
+
+#define PROFILE_SCOPE(context, subsystem, control) ProfileScope profileScope(context, subsystem, control)
+#else
+#define PROFILE_SCOPE(context, subsystem, control)
+#endif
+
+#if GMA3_STATISTICS
+#define STATISTICS_ADD(context, counter, value) ((context)->stats.counter += (value))
+#else
+#define STATISTICS_ADD(context, counter, value) ((void)0)
+#endif
+
+void Gma3Context::prefixName(const char *prefix) {
+	name(NAME_PREFIX, prefix, false);
+	}
+
+void Gma3Context::prefixName(const __FlashStringHelper *prefix) {
+	name(NAME_PREFIX, (const char*)prefix, true);
+	}
+
+void Gma3Context::dataPoolName(const char *pool) {
+	name(NAME_POOL, pool, false);
+	}
+
+void Gma3Context::dataPoolName(const __FlashStringHelper *pool) {
+	name(NAME_POOL, (const char*)pool, true);
+	}
+
+void Gma3Context::pageName(const char *page) {
+	name(NAME_PAGE, page, false);
+	}
+
+void Gma3Context::pageName(const __FlashStringHelper *page) {
+	name(NAME_PAGE, (const char*)page, true);
+	}
+
+void Gma3Context::faderName(const char *fader) {
+	name(NAME_FADER, fader, false);
+	}
+
+void Gma3Context::faderName(const __FlashStringHelper *fader) {
+	name(NAME_FADER, (const char*)fader, true);
+	}
+
+void Gma3Context::executorKnobName(const char *executorKnob) {
+	name(NAME_EXECUTOR_KNOB, executorKnob, false);
+	}
+
+void Gma3Context::executorKnobName(const __FlashStringHelper *executorKnob) {
+	name(NAME_EXECUTOR_KNOB, (const char*)executorKnob, true);
+	}
+
+void Gma3Context::keyName(const char *key) {
+	name(NAME_KEY, key, false);
+	}
+
+void Gma3Context::keyName(const __FlashStringHelper *key) {
+	name(NAME_KEY, (const char*)key, true);
+	}
+
+void Gma3Context::name(name_t type, const char *name, bool flash) {
+	namesWriteBegin();
+	names[type] = name;
+	if (flash) namesFlash |= 1 << type;
+	else namesFlash &= ~(1 << type);
+	if (type == NAME_PREFIX) prefixLength = flash ? strlen_P(name) : strlen(name);
+	namesWriteEnd();
+	}
+
+uint8_t Gma3Context::nameCopy(char *target, name_t type) {
+	if (namesFlash & (1 << type)) strcpy_P(target, names[type]);
+	else strcpy(target, names[type]);
+	return strlen(target);
+	}
+
+uint8_t Gma3Context::patternPrefix(char *pattern) {
+	uint8_t length;
+	uint16_t sequence;
+	do {
+		sequence = namesReadBegin();
+		length = 1;
+		pattern[0] = '/';
+		if (prefixLength != 0) {
+			length += nameCopy(pattern + length, NAME_PREFIX);
+			pattern[length++] = '/';
+			}
+		pattern[length] = 0;
+		} while (namesReadRetry(sequence));
+	return length;
+	}
+
+uint8_t Gma3Context::patternExecutor(char *pattern, name_t type, uint16_t pool, uint16_t page, uint16_t number) {
+	if (pool == 0) pool = poolCommon;
+	if (page == 0) page = pageCommon;
+	uint8_t length;
+	uint16_t sequence;
+	do {
+		sequence = namesReadBegin();
+		length = patternPrefix(pattern);
+		uint8_t size = nameCopy(pattern + length, NAME_POOL);
+		if (size != 0) {
+			length += size;
+			length += itod(pattern + length, pool);
+			pattern[length++] = '/';
+			}
+		size = nameCopy(pattern + length, NAME_PAGE);
+		if (size != 0) {
+			length += size;
+			length += itod(pattern + length, page);
+			pattern[length++] = '/';
+			}
+		length += nameCopy(pattern + length, type);
+		length += itod(pattern + length, number);
+		} while (namesReadRetry(sequence));
+	return length;
+	}
+
+// the pattern needs no zero termination, e.g. the begin of a packet
+bool Gma3Context::prefixCheck(const char *pattern, int32_t length) {
+	bool match;
+	uint16_t sequence;
+	do {
+		sequence = namesReadBegin();
+		if (prefixLength == 0) match = true;
+		else if (length < prefixLength + 2 || pattern[0] != '/' || pattern[prefixLength + 1] != '/') match = false;
+		else if (namesFlash & (1 << NAME_PREFIX)) match = strncmp_P(pattern + 1, names[NAME_PREFIX], prefixLength) == 0;
+		else match = strncmp(pattern + 1, names[NAME_PREFIX], prefixLength) == 0;
+		} while (namesReadRetry(sequence));
+	return match;
+	}
+
+uint8_t Gma3Context::prefixOffset() {
+	uint8_t offset;
+	uint16_t sequence;
+	do {
+		sequence = namesReadBegin();
+		offset = prefixLength != 0 ? prefixLength + 2 : 0;
+		} while (namesReadRetry(sequence));
+	return offset;
+	}
+
+void Gma3Context::interface(UDP &udp, IPAddress ip, uint16_t port) {
+	udp.begin(port);
+	destinationAdd(&udp, nullptr, UDPOSC, ip, port, PRIMARY);
+	}
+
+void Gma3Context::interface(Client &tcp, protocol_t protocol, IPAddress ip, uint16_t port) {
+	(void)protocol; // only TCP is possible in the moment
+	tcp.connect(ip, port);
+	destinationAdd(nullptr, &tcp, TCP, ip, port, PRIMARY);
+	}
+
+int8_t Gma3Context::destination(UDP &udp, IPAddress ip, uint16_t port, role_t role) {
+	return destinationAdd(&udp, nullptr, UDPOSC, ip, port, role);
+	}
+
+int8_t Gma3Context::destination(Client &tcp, IPAddress ip, uint16_t port, role_t role) {
+	tcp.connect(ip, port);
+	return destinationAdd(nullptr, &tcp, TCP, ip, port, role);
+	}
+
+void Gma3Context::destinationEnable(uint8_t index, bool state) {
+	if (index < destinationCount) destinations[index].enabled = state;
+	}
+
+bool Gma3Context::destinationHealth(uint8_t index) {
+	if (index < destinationCount) return destinationCheck(destinations[index]);
+	return false;
+	}
+
+void Gma3Context::failover(uint32_t timeout) {
+	failoverTimeout = timeout;
+	for (uint8_t i = 0; i < destinationCount; i++) destinations[i].seen = millis();
+	}
+
+int8_t Gma3Context::destinationAdd(UDP *udp, Client *tcp, protocol_t protocol, IPAddress ip, uint16_t port, role_t role) {
+	uint8_t index;
+	for (index = 0; index < destinationCount; index++) { // update an existing destination
+		struct Destination &destination = destinations[index];
+		if (destination.udp == udp && destination.tcp == tcp && destination.ip == (uint32_t)ip && destination.port == port) break;
 		}
+	if (index == DESTINATIONS_MAX) return -1;
+	if (index == destinationCount) destinationCount++;
+	struct Destination &destination = destinations[index];
+	destination.ip = ip;
+	destination.port = port;
+	destination.protocol = protocol;
+	destination.udp = udp;
+	destination.tcp = tcp;
+	destination.role = role;
+	destination.enabled = true;
+	destination.seen = millis();
+	return index;
+	}
+
+bool Gma3Context::destinationCheck(struct Destination &destination) {
+	if (!destination.enabled) return false;
+	if (destination.protocol == TCP) return destination.tcp->connected();
+	if (failoverTimeout == 0) return true;
+	return (millis() - destination.seen) < failoverTimeout;
+	}
+
+void Gma3Context::route(route_t type, protocol_t protocol) {
+	routing[type] = protocol;
+	if (type == ROUTE_OSC) sendMessage.protocol = protocol; // already for the next message
+	}
+
+protocol_t Gma3Context::route(route_t type) {
+	return routeProtocol(routing[type]);
+	}
+
+protocol_t Gma3Context::routeProtocol(protocol_t protocol) {
+	for (uint8_t i = 0; i < destinationCount; i++) {
+		if (destinations[i].protocol == protocol) return protocol;
+		}
+	if (protocol == UDPOSC) return TCP; // fallback to the configured interface
+	return UDPOSC;
+	}
+
+void Gma3Context::routeMessage(route_t type) {
+	mergeFlush(); // before the route is set, sending the merged commands resets it
+	sendMessage.protocol = routing[type];
+	sendRoute = type;
+	}
+
+void Gma3Context::sendOSC() {
+	protocol_t protocol = routeProtocol(sendMessage.protocol);
+	sendMessage.protocol = routing[ROUTE_OSC]; // next message uses the default route
+#if GMA3_RATE_LIMIT
+	if (rateActive) {
+		uint32_t time = millis();
+		const uint8_t types[2] = {sendRoute, ROUTE_TYPES};
+		for (uint8_t i = 0; i < 2; i++) {
+			struct RateLimit &limit = rateLimits[types[i]];
+			if (limit.rate == 0) continue;
+			rateRefill(limit, time);
+			if (limit.tokens > -(int32_t)limit.burst * 1000) limit.tokens -= 1000; // the debt of keys and commands is limited
+			}
+		}
+#endif
+	if (bundleActive) bundleElement(protocol);
+	else {
+		sendPacket(sendMessage.message, sendMessage.size, protocol);
+#if GMA3_LATENCY
+		latencyEnd();
+#endif
+		}
+	sendRoute = ROUTE_OSC;
+	}
+
+void Gma3Context::sendPacket(const uint8_t *packet, int32_t size, protocol_t protocol) {
+#if GMA3_STATISTICS
+	if (!idleMuted) activity(); // the flag is only used by the sending task
+#else
+	activity();
+#endif
+#if GMA3_THREADED
+	if (queueActive) {
+		if (!queuePush(packet, size, protocol)) STATISTICS_ADD(this, queueDrops, 1);
+		return;
+		}
+#endif
+	transmitPacket(packet, size, protocol);
+	}
+
+void Gma3Context::transmitPacket(const uint8_t *packet, int32_t size, protocol_t protocol) {
+	PROFILE_SCOPE(this, PROFILE_SEND, nullptr);
+	if (captureOutput != nullptr) captureFrame(protocol == TCP ? CAPTURE_TCP : 0, packet, size);
+	bool primary = false; // backups are only used if no primary of the same protocol is available
+	for (uint8_t i = 0; i < destinationCount; i++) {
+		if (destinations[i].role == PRIMARY && destinations[i].protocol == protocol && destinationCheck(destinations[i])) {
+			primary = true;
+			break;
+			}
+		}
+	for (uint8_t i = 0; i < destinationCount; i++) {
+		struct Destination &destination = destinations[i];
+		if (!destination.enabled || destination.protocol != protocol) continue;
+		if (destination.role == BACKUP && primary) continue;
+		bool sent = false;
+		switch (protocol) {
+			case UDPOSC:
+				sent = destination.udp->beginPacket(IPAddress(destination.ip), destination.port);
+				if (sent) sent = destination.udp->write(packet, size) == (size_t)size;
+				if (sent) sent = destination.udp->endPacket();
+				break;
+			case TCP: {
+				if (!destination.tcp->connected()) {
+					destination.tcp->connect(IPAddress(destination.ip), destination.port);
+					STATISTICS_ADD(this, tcpReconnects, 1);
+					}
+				sent = destination.tcp->write(packet, size) == (size_t)size;
+				break;
+				}
+			}
+		if (sent) {
+			STATISTICS_ADD(this, packetsSent, 1);
+			STATISTICS_ADD(this, bytesSent, size);
+			}
+		else STATISTICS_ADD(this, sendFailures, 1);
+		}
+	}
+
+void Gma3Context::bundleBegin(uint64_t timetag) {
+	bundleActive = true;
+	bundleSize = 0;
+	bundleTimetag = timetag;
+	}
+
+void Gma3Context::bundleEnd() {
+	mergeFlush();
+	if (bundleSize > 0) sendPacket(bundleMessage, bundleSize, bundleProtocol);
+	bundleActive = false;
+	bundleSize = 0;
+	}
+
+void Gma3Context::bundleElement(protocol_t protocol) {
+	const uint8_t header[8] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0};
+	if (bundleSize > 0 && ((bundleSize + 4 + sendMessage.size) > bundleCapacity || protocol != bundleProtocol)) { // split large bundles
+		sendPacket(bundleMessage, bundleSize, bundleProtocol);
+		bundleSize = 0;
+		}
+	if (sizeof(header) + 8 + 4 + sendMessage.size > bundleCapacity) { // too large for a bundle or bundles disabled
+		sendPacket(sendMessage.message, sendMessage.size, protocol);
+		return;
+		}
+	if (bundleSize == 0) {
+		memcpy(bundleMessage, header, sizeof(header));
+		itoh(bundleMessage + 8, 0, bundleTimetag >> 32);
+		itoh(bundleMessage + 12, 0, bundleTimetag & 0xFFFFFFFF);
+		bundleProtocol = protocol;
+		bundleSize = sizeof(header) + 8;
+		}
+	itoh(bundleMessage + bundleSize, 0, sendMessage.size); // the bundle can be larger than the uint8_t index
+	memcpy(bundleMessage + bundleSize + 4, sendMessage.message, sendMessage.size);
+	bundleSize += 4 + sendMessage.size;
+	}
+
+void Gma3Context::command(const char cmd[]) {
+#if GMA3_MERGE
+	if (commandMerging) {
+		size_t length = strlen(cmd);
+		if (commandLength > 0 && commandLength + 2 + length >= sizeof(commandPending)) commandFlush();
+		if (length < sizeof(commandPending)) {
+			if (commandLength > 0) {
+				memcpy(commandPending + commandLength, "; ", 2);
+				commandLength += 2;
+				}
+			memcpy(commandPending + commandLength, cmd, length + 1);
+			commandLength += length;
+			return;
+			}
+		}
+#endif
+	char pattern[OSC_PATTERN_SIZE];
+	patternPrefix(pattern);
+	strcat(pattern, "cmd");
+	routeMessage(ROUTE_COMMAND);
+	oscMessage(pattern, cmd);
+	}
+
+#if GMA3_MERGE
+void Gma3Context::commandMerge(bool state) {
+	if (!state && commandLength > 0) commandFlush();
+	commandMerging = state;
+	}
+
+void Gma3Context::commandFlush() {
+	char pattern[OSC_PATTERN_SIZE];
+	patternPrefix(pattern);
+	strcat(pattern, "cmd");
+	commandLength = 0; // before the message, oscMessage() flushes pending commands
+	routeMessage(ROUTE_COMMAND);
+	oscMessage(pattern, commandPending);
+	}
+#endif
+
+#if GMA3_RATE_LIMIT
+void Gma3Context::rateLimit(uint16_t rate, uint16_t burst) {
+	rateLimit(ROUTE_TYPES, rate, burst);
+	}
+
+void Gma3Context::rateLimit(route_t type, uint16_t rate, uint16_t burst) {
+	struct RateLimit &limit = rateLimits[type];
+	limit.rate = rate;
+	limit.burst = burst > 0 ? burst : rate / 10 + 1;
+	limit.tokens = (int32_t)limit.burst * 1000;
+	limit.time = millis();
+	rateActive = false;
+	for (uint8_t i = 0; i <= ROUTE_TYPES; i++) {
+		if (rateLimits[i].rate > 0) rateActive = true;
+		}
+	}
+
+const struct RateLimit& Gma3Context::rateState() {
+	return rateLimits[ROUTE_TYPES];
+	}
+
+const struct RateLimit& Gma3Context::rateState(route_t type) {
+	return rateLimits[type];
+	}
+
+// true if a message of this type can be sent now, otherwise the control sends its latest value later
+bool Gma3Context::rateCheck(route_t type) {
+	if (!rateActive) return true;
+	uint32_t time = millis();
+	bool allowed = true;
+	const uint8_t types[2] = {type, ROUTE_TYPES};
+	for (uint8_t i = 0; i < 2; i++) {
+		struct RateLimit &limit = rateLimits[types[i]];
+		if (limit.rate == 0) continue;
+		rateRefill(limit, time);
+		if (limit.tokens < 1000) allowed = false;
+		}
+	if (!allowed) {
+		rateLimits[type].throttled++;
+		if (type != ROUTE_TYPES) rateLimits[ROUTE_TYPES].throttled++;
+		}
+	return allowed;
+	}
+
+void Gma3Context::rateRefill(struct RateLimit &limit, uint32_t time) {
+	uint32_t elapsed = time - limit.time;
+	if (elapsed == 0) return;
+	limit.time = time;
+	int32_t full = (int32_t)limit.burst * 1000;
+	if (elapsed > 60000) elapsed = 60000; // no overflow, the bucket is full anyway
+	uint32_t tokens = elapsed * limit.rate; // ms * messages/s = 1/1000 messages
+	if ((int64_t)limit.tokens + tokens >= full) limit.tokens = full;
+	else limit.tokens += tokens;
+	}
+#endif
+
+void Gma3Context::sendAddress(const char address[], int32_t value) {
+	char pattern[OSC_PATTERN_SIZE];
+	patternPrefix(pattern);
+	strcat(pattern, address);
+	routeMessage(ROUTE_COMMAND);
+	oscMessage(pattern, value);
+	}
+
+void Gma3Context::clockOffset(uint64_t timetag) {
+	clockTimetag = timetag;
+	clockTime = millis();
+	}
+
+void Gma3Context::clockOffsetUnix(uint32_t seconds, uint16_t milliseconds) {
+	clockOffset(((uint64_t)(seconds + TIMETAG_UNIX_OFFSET) << 32) + ((uint64_t)milliseconds << 32) / 1000);
+	}
+
+uint64_t Gma3Context::timetag(uint32_t time) {
+	if (clockTimetag == 0) return TIMETAG_IMMEDIATE;
+	int32_t elapsed = time - clockTime; // negative for times before the offset was set
+	return clockTimetag + (int64_t)elapsed * 4294967296LL / 1000;
+	}
+
+#if GMA3_MACROS
+bool Gma3Context::macro(const char *steps) {
+	return macroStart(steps, false, nullptr);
+	}
+
+bool Gma3Context::macro(const __FlashStringHelper *steps) {
+	return macroStart((const char*)steps, true, nullptr);
+	}
+
+void Gma3Context::macroStop() {
+	for (uint8_t i = 0; i < MACRO_SLOTS; i++) macros[i].steps = nullptr;
+	}
+
+bool Gma3Context::macroStart(const char *steps, bool flash, const void *owner) {
+	struct Macro *slot = nullptr;
+	for (uint8_t i = 0; i < MACRO_SLOTS; i++) {
+		if (owner != nullptr && macros[i].steps != nullptr && macros[i].owner == owner) { // restart
+			slot = &macros[i];
+			break;
+			}
+		if (slot == nullptr && macros[i].steps == nullptr) slot = &macros[i];
+		}
+	if (slot == nullptr) return false;
+	slot->steps = steps;
+	slot->owner = owner;
+	slot->position = 0;
+	slot->due = millis();
+	slot->flash = flash;
+	macroRun(); // the first step without delay
+	return true;
+	}
+
+// cooperative scheduler, runs the due steps of all sequences until the next wait
+void Gma3Context::macroRun() {
+	uint32_t now = millis();
+	for (uint8_t i = 0; i < MACRO_SLOTS; i++) {
+		struct Macro &macro = macros[i];
+		while (macro.steps != nullptr && (int32_t)(now - macro.due) >= 0) {
+			char step[OSC_STRING_SIZE];
+			uint16_t length = 0; // OSC_STRING_SIZE can exceed 255
+			char data;
+			while ((data = macro.flash ? pgm_read_byte(macro.steps + macro.position) : macro.steps[macro.position]) != 0) {
+				macro.position++;
+				if (data == MACRO_SEPARATOR) break;
+				if (length < sizeof(step) - 1) step[length++] = data;
+				}
+			step[length] = 0;
+			if (data == 0) macro.steps = nullptr; // last step
+			if (step[0] == MACRO_WAIT) {
+				int32_t wait = 0;
+				dtoi(step + 1, wait);
+				macro.due += wait; // relative to the planned time, a late step doesn't delay the following steps
+				}
+			else if (length > 0) command(step);
+			}
+		}
+	}
+#endif
+
+uint16_t Gma3Context::commonPool() {
+	return poolCommon;
+	}
+
+void Gma3Context::commonPool(uint16_t pool) {
+	poolCommon = pool;
+	}
+
+uint16_t Gma3Context::commonPage() {
+	return pageCommon;
+	}
+
+void Gma3Context::commonPage(uint16_t page) {
+	pageCommon = page;
+	}
+
+bool Gma3Context::sendFits(int32_t size) {
+	if (size <= sendMessage.capacity) return true;
+	STATISTICS_ADD(this, oversizedSends, 1);
+	sendMessage.protocol = routing[ROUTE_OSC]; // next message uses the default route
+	return false;
+	}
+
+void Gma3Context::oscMessage(const char pattern[], const char string[]) {
+	mergeFlush(); // merged commands are sent before, so the order is kept
+	int patternLength = strlen(pattern);
+	int stringLength = strlen(string);
+	int patternOffset = patternLength % 4;
+	int tagStart;
+	if (patternOffset == 0) tagStart = patternLength + 4;
+	else tagStart = patternLength + (4 - patternOffset);
+	int stringStart = tagStart + 4;
+	int stringOffset = stringLength % 4;
+	int size;
+	if (stringOffset == 0) size = stringStart + stringLength + 4;
+	else size = stringStart + stringLength + (4 - stringOffset);
+	if (!sendFits(size)) return;
+	memset(sendMessage.message, 0, size);
+	memcpy(sendMessage.message, pattern, patternLength);
+	memcpy(sendMessage.message + tagStart, ",s\0\0", 4);
+	memcpy(sendMessage.message + stringStart, string, stringLength);
+	sendMessage.size = size;
+	sendOSC();
+	}
+
+void Gma3Context::oscMessage(const char pattern[], float float32) {
+	mergeFlush();
+	int patternLength = strlen(pattern);
+	int patternOffset = patternLength % 4;
+	int tagStart;
+	if (patternOffset == 0) tagStart = patternLength + 4;
+	else tagStart = patternLength + (4 - patternOffset);
+	int dataStart = tagStart + 4;
+	if (!sendFits(dataStart + 4)) return;
+	memset(sendMessage.message, 0, dataStart);
+	memcpy(sendMessage.message, pattern, patternLength);
+	memcpy(sendMessage.message + tagStart, ",f\0\0", 4);
+	ftoh(sendMessage.message, dataStart, float32);
+	sendMessage.size = dataStart + 4;
+	sendOSC();
+	}
+
+void Gma3Context::oscMessage(const char pattern[], int32_t int32) {
+	mergeFlush();
+	int patternLength = strlen(pattern);
+	int patternOffset = patternLength % 4;
+	int tagStart;
+	if (patternOffset == 0) tagStart = patternLength + 4;
+	else tagStart = patternLength + (4 - patternOffset);
+	int dataStart = tagStart + 4;
+	if (!sendFits(dataStart + 4)) return;
+	memset(sendMessage.message, 0, dataStart);
+	memcpy(sendMessage.message, pattern, patternLength);
+	memcpy(sendMessage.message + tagStart, ",i\0\0", 4);
+	itoh(sendMessage.message, dataStart, int32);
+	sendMessage.size = dataStart + 4;
+	sendOSC();
+	}
+
+void Gma3Context::oscMessage(const char pattern[]) {
+	mergeFlush();
+	int patternLength = strlen(pattern);
+	int patternOffset = patternLength % 4;
+	int tagStart;
+	if (patternOffset == 0) tagStart = patternLength + 4;
+	else tagStart = patternLength + (4 - patternOffset);
+	if (!sendFits(tagStart + 4)) return;
+	memset(sendMessage.message, 0, tagStart);
+	memcpy(sendMessage.message, pattern, patternLength);
+	memcpy(sendMessage.message + tagStart, ",\0\0\0", 4);
+	sendMessage.size = tagStart + 4;
+	sendOSC();
+	}
+
+void Gma3Context::update() {
+	mergeFlush(); // commands of this loop
+#if GMA3_LATENCY
+	latencyPending = false; // input events without a message
+#endif
+#if GMA3_STATISTICS
+	uint32_t now = micros();
+	if (loopLast != 0) {
+		uint32_t loopTime = now - loopLast;
+		if (loopTime > stats.loopTimeMax) stats.loopTimeMax = loopTime;
+		stats.loopTimeAverage += ((int32_t)loopTime - (int32_t)stats.loopTimeAverage) / 16; // moving average
+		}
+	loopLast = now;
+	if (statsInterval > 0 && (millis() - statsTime) >= statsInterval) {
+		statsTime = millis();
+		idleMuted = true; // publishing is no activity
+		statisticsSend();
+		idleMuted = false;
+		}
+#endif
+#if GMA3_MACROS
+	macroRun();
+#endif
+	mergeFlush();
+	if (idleTimeout > 0) {
+		uint32_t time = millis();
+		if (idleWoken()) {
+			idleWoken(false);
+			activityTime = time;
+			}
+		if (time - activityTime < idleTimeout) idleScan = true;
+		else if (time - idleTime >= idleInterval) {
+			idleScan = true;
+			idleTime = time;
+			}
+		else idleScan = false;
+		}
+	}
+
+void Gma3Context::idle(uint32_t timeout, uint32_t interval) {
+	idleTimeout = timeout;
+	idleInterval = interval;
+	activityTime = millis();
+	idleScan = true;
+	}
+
+void Gma3Context::wake() {
+	idleWoken(true);
+	}
+
+void Gma3Context::activity() {
+	if (idleTimeout > 0) {
+		activityTime = millis();
+		idleScan = true;
+		}
+	}
+
+#if GMA3_STATISTICS
+const struct Statistics& Gma3Context::statistics() {
+	return stats;
+	}
+
+void Gma3Context::statisticsReset() {
+	memset(&stats, 0, sizeof(stats));
+	}
+
+void Gma3Context::statisticsPublish(const char *address, uint32_t interval) {
+	memset(statsAddress, 0, NAME_LENGTH_MAX);
+	strncpy(statsAddress, address, NAME_LENGTH_MAX - 1);
+	statsInterval = interval;
+	statsTime = millis();
+	}
+
+void Gma3Context::statisticsSend() {
+	const char *names[] = {"packetsSent", "bytesSent", "packetsReceived", "bytesReceived", "sendFailures",
+		"oversizedReceives", "oversizedSends", "parseErrors", "prefixRejects", "filterRejects", "tcpReconnects", "queueDrops", "loopTimeMax", "loopTimeAverage"};
+	const uint32_t values[] = {stats.packetsSent, stats.bytesSent, stats.packetsReceived, stats.bytesReceived, stats.sendFailures,
+		stats.oversizedReceives, stats.oversizedSends, stats.parseErrors, stats.prefixRejects, stats.filterRejects, stats.tcpReconnects, stats.queueDrops, stats.loopTimeMax, stats.loopTimeAverage};
+	bundleBegin();
+	for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		char pattern[OSC_PATTERN_SIZE];
+		patternPrefix(pattern);
+		strcat(pattern, statsAddress);
+		pattern[strlen(pattern)] = '/';
+		strcat(pattern, names[i]);
+		oscMessage(pattern, (int32_t)values[i]);
+		}
+	bundleEnd();
+	}
+#endif
+
+void Gma3Context::capture(Print &output) {
+	output.write((const uint8_t*)CAPTURE_HEADER, sizeof(CAPTURE_HEADER) - 1);
+	output.write((uint8_t)CAPTURE_VERSION);
+	captureOutput = &output;
+	}
+
+void Gma3Context::captureStop() {
+	if (captureOutput != nullptr) captureOutput->flush();
+	captureOutput = nullptr;
+	}
+
+void Gma3Context::captureFrame(uint8_t flags, const uint8_t *packet, int32_t size) {
+	uint8_t frame[7];
+	itoh(frame, 0, micros());
+	frame[4] = flags;
+	frame[5] = size >> 8;
+	frame[6] = size & 0xFF;
+	captureOutput->write(frame, sizeof(frame));
+	captureOutput->write(packet, size);
+	}
+
+// CRC-16/CCITT-FALSE, bitwise without a table to save flash memory
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t size) {
+	while (size--) {
+		crc ^= (uint16_t)*data++ << 8;
+		for (uint8_t bit = 0; bit < 8; bit++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	return crc;
+	}
+
+static inline void snapshotPut(uint8_t *target, uint16_t value) {
+	target[0] = value >> 8;
+	target[1] = value & 0xFF;
+	}
+
+static inline uint16_t snapshotGet(const uint8_t *source) {
+	return (source[0] << 8) | source[1];
+	}
+
+static bool snapshotWrite(SnapshotStorage &storage, uint32_t &position, const uint8_t *data, uint16_t size, uint16_t &crc) {
+	crc = crc16(crc, data, size);
+	bool written = storage.write(position, data, size);
+	position += size;
+	return written;
+	}
+
+static bool snapshotRead(SnapshotStorage &storage, uint32_t &position, uint32_t end, uint8_t *data, uint16_t size, uint16_t &crc) {
+	if (position + size > end || !storage.read(position, data, size)) return false;
+	crc = crc16(crc, data, size);
+	position += size;
+	return true;
+	}
+
+uint16_t Gma3Context::snapshotSize() {
+	uint16_t size = SNAPSHOT_HEADER_SIZE + 10; // common page and pool, three counts
+	for (Fader *fader = faderList; fader != nullptr; fader = fader->faderNext) size += 11;
+	for (Key *key = keyList; key != nullptr; key = key->keyNext) size += 6;
+	for (ExecutorKnob *knob = executorKnobList; knob != nullptr; knob = knob->executorKnobNext) size += 6;
+	return size;
+	}
+
+bool Gma3Context::snapshotSave(SnapshotStorage &storage, uint32_t address) {
+	uint32_t position = address + SNAPSHOT_HEADER_SIZE;
+	uint16_t crc = 0xFFFF;
+	uint8_t entry[11];
+	snapshotPut(entry, pageCommon);
+	snapshotPut(entry + 2, poolCommon);
+	bool written = snapshotWrite(storage, position, entry, 4, crc);
+	uint16_t count = 0;
+	for (Fader *fader = faderList; fader != nullptr; fader = fader->faderNext) count++;
+	snapshotPut(entry, count);
+	written &= snapshotWrite(storage, position, entry, 2, crc);
+	for (Fader *fader = faderList; fader != nullptr; fader = fader->faderNext) {
+		snapshotPut(entry, fader->fader);
+		snapshotPut(entry + 2, fader->pageLocal);
+		snapshotPut(entry + 4, fader->poolLocal);
+		snapshotPut(entry + 6, fader->fetchValue);
+		entry[8] = (fader->lockState ? SNAPSHOT_LOCKED : 0) | (fader->analogLast >= 0 ? SNAPSHOT_VALUE : 0);
+		snapshotPut(entry + 9, fader->valueLast);
+		written &= snapshotWrite(storage, position, entry, 11, crc);
+		}
+	count = 0;
+	for (Key *key = keyList; key != nullptr; key = key->keyNext) count++;
+	snapshotPut(entry, count);
+	written &= snapshotWrite(storage, position, entry, 2, crc);
+	for (Key *key = keyList; key != nullptr; key = key->keyNext) {
+		snapshotPut(entry, key->key);
+		snapshotPut(entry + 2, key->pageLocal);
+		snapshotPut(entry + 4, key->poolLocal);
+		written &= snapshotWrite(storage, position, entry, 6, crc);
+		}
+	count = 0;
+	for (ExecutorKnob *knob = executorKnobList; knob != nullptr; knob = knob->executorKnobNext) count++;
+	snapshotPut(entry, count);
+	written &= snapshotWrite(storage, position, entry, 2, crc);
+	for (ExecutorKnob *knob = executorKnobList; knob != nullptr; knob = knob->executorKnobNext) {
+		snapshotPut(entry, knob->executorKnob);
+		snapshotPut(entry + 2, knob->pageLocal);
+		snapshotPut(entry + 4, knob->poolLocal);
+		written &= snapshotWrite(storage, position, entry, 6, crc);
+		}
+	// the header is written last, a snapshot interrupted by a power loss fails the CRC check
+	uint8_t header[SNAPSHOT_HEADER_SIZE];
+	memcpy(header, SNAPSHOT_HEADER, sizeof(SNAPSHOT_HEADER) - 1);
+	header[sizeof(SNAPSHOT_HEADER) - 1] = SNAPSHOT_VERSION;
+	snapshotPut(header + 8, position - address - SNAPSHOT_HEADER_SIZE);
+	snapshotPut(header + 10, crc);
+	return written && storage.write(address, header, sizeof(header)) && storage.commit();
+	}
+
+bool Gma3Context::snapshotRecall(SnapshotStorage &storage, uint32_t address) {
+	uint8_t header[SNAPSHOT_HEADER_SIZE];
+	if (!storage.read(address, header, sizeof(header))) return false;
+	if (memcmp(header, SNAPSHOT_HEADER, sizeof(SNAPSHOT_HEADER) - 1) != 0 || header[sizeof(SNAPSHOT_HEADER) - 1] != SNAPSHOT_VERSION) return false;
+	uint16_t size = snapshotGet(header + 8);
+	uint16_t crc = 0xFFFF;
+	if (!snapshotPayload(storage, address, size, false, crc) || crc != snapshotGet(header + 10)) return false; // checked before anything is changed
+	crc = 0xFFFF;
+	bundleBegin(); // the values of the faders are sent as one transmission
+	bool recalled = snapshotPayload(storage, address, size, true, crc);
+	bundleEnd();
+	return recalled;
+	}
+
+// reads the payload once for the CRC check and once more to restore the controls
+bool Gma3Context::snapshotPayload(SnapshotStorage &storage, uint32_t address, uint16_t size, bool restore, uint16_t &crc) {
+	uint32_t position = address + SNAPSHOT_HEADER_SIZE;
+	uint32_t end = position + size;
+	uint8_t entry[11];
+	if (!snapshotRead(storage, position, end, entry, 4, crc)) return false;
+	if (restore) {
+		pageCommon = snapshotGet(entry);
+		poolCommon = snapshotGet(entry + 2);
+		}
+	if (!snapshotRead(storage, position, end, entry, 2, crc)) return false;
+	uint16_t count = snapshotGet(entry);
+	Fader *fader = faderList;
+	for (uint16_t i = 0; i < count; i++) {
+		if (!snapshotRead(storage, position, end, entry, 11, crc)) return false;
+		if (restore && fader != nullptr && fader->fader == snapshotGet(entry)) { // a changed surface restores only the matching controls
+			fader->pageLocal = snapshotGet(entry + 2);
+			fader->poolLocal = snapshotGet(entry + 4);
+			fader->fetchValue = snapshotGet(entry + 6);
+			fader->lockState = entry[8] & SNAPSHOT_LOCKED;
+			if (entry[8] & SNAPSHOT_VALUE) {
+				fader->valueLast = (int16_t)snapshotGet(entry + 9);
+				if (!fader->lockState) fader->send();
+				}
+			}
+		if (fader != nullptr) fader = fader->faderNext;
+		}
+	if (!snapshotRead(storage, position, end, entry, 2, crc)) return false;
+	count = snapshotGet(entry);
+	Key *key = keyList;
+	for (uint16_t i = 0; i < count; i++) {
+		if (!snapshotRead(storage, position, end, entry, 6, crc)) return false;
+		if (restore && key != nullptr && key->key == snapshotGet(entry)) {
+			key->pageLocal = snapshotGet(entry + 2);
+			key->poolLocal = snapshotGet(entry + 4);
+			}
+		if (key != nullptr) key = key->keyNext;
+		}
+	if (!snapshotRead(storage, position, end, entry, 2, crc)) return false;
+	count = snapshotGet(entry);
+	ExecutorKnob *knob = executorKnobList;
+	for (uint16_t i = 0; i < count; i++) {
+		if (!snapshotRead(storage, position, end, entry, 6, crc)) return false;
+		if (restore && knob != nullptr && knob->executorKnob == snapshotGet(entry)) {
+			knob->pageLocal = snapshotGet(entry + 2);
+			knob->poolLocal = snapshotGet(entry + 4);
+			}
+		if (knob != nullptr) knob = knob->executorKnobNext;
+		}
+	return position == end;
+	}
+
+#if GMA3_THREADED
+void Gma3Context::threaded(bool state) {
+	if (!state) transmit(); // send the remaining packets
+	queueActive = state;
+	}
+
+void Gma3Context::transmit() {
+	uint16_t tail = queueTail.load(std::memory_order_relaxed);
+	uint16_t head = queueHead.load(std::memory_order_acquire);
+	while (tail != head) {
+		if (OSC_QUEUE_SIZE - tail < 3 || (queue[tail] == 0xFF && queue[tail + 1] == 0xFF)) tail = 0; // wrap around
+		else {
+			int32_t size = (queue[tail] << 8) | queue[tail + 1];
+			transmitPacket(queue + tail + 3, size, (protocol_t)queue[tail + 2]);
+			tail += size + 3;
+			if (tail == OSC_QUEUE_SIZE) tail = 0;
+			}
+		queueTail.store(tail, std::memory_order_release);
+		}
+	}
+
+// single producer, single consumer, a packet is stored contiguous so it can be sent from the queue
+bool Gma3Context::queuePush(const uint8_t *packet, int32_t size, protocol_t protocol) {
+	int32_t length = size + 3;
+	if (length >= OSC_QUEUE_SIZE) return false;
+	uint16_t head = queueHead.load(std::memory_order_relaxed);
+	uint16_t tail = queueTail.load(std::memory_order_acquire);
+	uint16_t position = head;
+	if (head >= tail) {
+		if (OSC_QUEUE_SIZE - head < length || (OSC_QUEUE_SIZE - head == length && tail == 0)) { // continue at the begin
+			if (length >= tail) return false;
+			if (OSC_QUEUE_SIZE - head >= 3) queue[head] = queue[head + 1] = 0xFF; // wrap marker
+			position = 0;
+			}
+		}
+	else if (head + length >= tail) return false;
+	queue[position] = size >> 8;
+	queue[position + 1] = size & 0xFF;
+	queue[position + 2] = protocol;
+	memcpy(queue + position + 3, packet, size);
+	position += length;
+	if (position == OSC_QUEUE_SIZE) position = 0;
+	queueHead.store(position, std::memory_order_release);
+	return true;
+	}
+#endif
+
+#if GMA3_LATENCY
+const struct Latency& Gma3Context::latency(route_t type) {
+	return latencyHistograms[type];
+	}
+
+void Gma3Context::latencyReset() {
+	memset(latencyHistograms, 0, sizeof(latencyHistograms));
+	}
+
+void Gma3Context::latencyPrint(Print &output) {
+	const char *names[] = {"Key", "Fader", "ExecutorKnob", "Command", "OSC"};
+	for (uint8_t type = 0; type < ROUTE_TYPES; type++) {
+		output.print("latency ");
+		output.print(names[type]);
+		output.print(" ");
+		output.print((unsigned long)latencyHistograms[type].max);
+		for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+			output.print(" ");
+			output.print((unsigned long)latencyHistograms[type].buckets[i]);
+			}
+		output.println();
+		}
+	}
+
+void Gma3Context::latencyBegin(route_t type) {
+	latencyTime = micros();
+	latencyType = type;
+	latencyPending = true;
+	}
+
+void Gma3Context::latencyEnd() {
+	if (latencyPending && latencyType == sendRoute) { // only the message caused by the input event
+		uint32_t time = micros() - latencyTime;
+		struct Latency &histogram = latencyHistograms[latencyType];
+		uint8_t bucket = 0;
+		while ((time >> (bucket + 1)) != 0 && bucket < LATENCY_BUCKETS - 1) bucket++; // log2
+		histogram.buckets[bucket]++;
+		histogram.count++;
+		if (time > histogram.max) histogram.max = time;
+		latencyPending = false;
+		}
+	}
+
+#endif
+
+#if GMA3_PROFILE
+void Gma3Context::profile(bool state) {
+#if defined(PROFILE_DWT)
+	if (state) {
+		PROFILE_DEMCR |= (1 << 24); // enable trace
+		PROFILE_DWT_CTRL |= 1; // enable the cycle counter
+		}
+#endif
+	if (state && !profileActive && profileTime == 0) profileTime = millis();
+	profileActive = state;
+	}
+
+void Gma3Context::profileReset() {
+	for (uint8_t i = 0; i < PROFILE_SUBSYSTEMS + PROFILE_CONTROLS_MAX; i++) {
+		profileEntries[i].calls = 0;
+		profileEntries[i].max = 0;
+		profileEntries[i].total = 0;
+		}
+	profileTime = millis();
+	}
+
+bool Gma3Context::profileControl(const void *control, const char *name) {
+	if (profileControls == PROFILE_CONTROLS_MAX) return false;
+	struct Profile &entry = profileEntries[PROFILE_SUBSYSTEMS + profileControls];
+	entry.control = control;
+	entry.name = name;
+	profileControls++;
+	return true;
+	}
+
+// ranks all used entries by the total time, returns the number of entries
+static uint8_t profileRank(const struct Profile *entries, uint8_t count, uint8_t *rank) {
+	uint8_t used = 0;
+	for (uint8_t i = 0; i < count; i++) {
+		if (entries[i].calls == 0) continue;
+		uint8_t j = used++;
+		while (j > 0 && entries[rank[j - 1]].total < entries[i].total) { // insertion sort
+			rank[j] = rank[j - 1];
+			j--;
+			}
+		rank[j] = i;
+		}
+	return used;
+	}
+
+static const char* profileName(const struct Profile *entries, uint8_t index) {
+	const char *names[] = {"Parser", "Send", "Key", "Fader", "Analog", "ExecutorKnob", "CmdButton", "PagesPools"};
+	if (index < PROFILE_SUBSYSTEMS) return names[index];
+	return entries[index].name;
+	}
+
+void Gma3Context::profilePrint(Print &output) {
+	uint8_t rank[PROFILE_SUBSYSTEMS + PROFILE_CONTROLS_MAX];
+	uint8_t count = profileRank(profileEntries, PROFILE_SUBSYSTEMS + profileControls, rank);
+	uint32_t elapsed = millis() - profileTime;
+	output.print("profile ");
+	output.print((unsigned long)elapsed);
+	output.println("ms");
+	output.println("rank name calls total_us avg_us max_us percent");
+	for (uint8_t i = 0; i < count; i++) {
+		const struct Profile &entry = profileEntries[rank[i]];
+		uint32_t total = entry.total / PROFILE_TICKS_PER_US;
+		output.print((unsigned int)(i + 1));
+		output.print(" ");
+		output.print(profileName(profileEntries, rank[i]));
+		output.print(" ");
+		output.print((unsigned long)entry.calls);
+		output.print(" ");
+		output.print((unsigned long)total);
+		output.print(" ");
+		output.print((unsigned long)(total / entry.calls));
+		output.print(" ");
+		output.print((unsigned long)(entry.max / PROFILE_TICKS_PER_US));
+		output.print(" ");
+		output.println(elapsed > 0 ? total / (elapsed * 10.0) : 0.0);
+		}
+	}
+
+void Gma3Context::profileSend(const char *address) {
+	uint8_t rank[PROFILE_SUBSYSTEMS + PROFILE_CONTROLS_MAX];
+	uint8_t count = profileRank(profileEntries, PROFILE_SUBSYSTEMS + profileControls, rank);
+	bundleBegin();
+	for (uint8_t i = 0; i < count; i++) {
+		char pattern[OSC_PATTERN_SIZE];
+		patternPrefix(pattern);
+		strcat(pattern, address);
+		pattern[strlen(pattern)] = '/';
+		strncat(pattern, profileName(profileEntries, rank[i]), sizeof(pattern) - strlen(pattern) - 1);
+		oscMessage(pattern, (int32_t)(profileEntries[rank[i]].total / PROFILE_TICKS_PER_US));
+		}
+	bundleEnd();
+	}
+
+#endif
+void Gma3Context::resync(bool page) {
+	bundleBegin();
+	for (Fader *fader = faderList; fader != nullptr; fader = fader->faderNext) {
+		if (fader->lockState) continue;
+		if (fader->analogLast < 0) continue; // no value read yet
+		if (page && fader->pageLocal > 0) continue;
+		if (!page && fader->poolLocal > 0) continue;
+		fader->send();
+		}
+	bundleEnd();
+	}
+
+void prefixName(const char *prefix) {
+	gma3.prefixName(prefix);
+	}
+
+void prefixName(const __FlashStringHelper *prefix) {
+	gma3.prefixName(prefix);
 	}
 
 void dataPoolName(const char *pool) {
-	memset(namePool, 0, NAME_LENGTH_MAX);
-	strcpy(namePool, pool);
+	gma3.dataPoolName(pool);
+	}
+
+void dataPoolName(const __FlashStringHelper *pool) {
+	gma3.dataPoolName(pool);
 	}
 
 void pageName(const char *page) {
-	memset(namePage, 0, NAME_LENGTH_MAX);
-	strcpy(namePage, page);
+	gma3.pageName(page);
+	}
+
+void pageName(const __FlashStringHelper *page) {
+	gma3.pageName(page);
 	}
 
 void faderName(const char *fader) {
-	memset(nameFader, 0, NAME_LENGTH_MAX);
-	strcpy(nameFader, fader);
+	gma3.faderName(fader);
+	}
+
+void faderName(const __FlashStringHelper *fader) {
+	gma3.faderName(fader);
 	}
 
 void executorKnobName(const char *executorKnob) {
-	memset(nameExecutorKnob, 0, NAME_LENGTH_MAX);
-	strcpy(nameExecutorKnob, executorKnob);
+	gma3.executorKnobName(executorKnob);
+	}
+
+void executorKnobName(const __FlashStringHelper *executorKnob) {
+	gma3.executorKnobName(executorKnob);
 	}
 
 void keyName(const char *key) {
-	memset(nameKey, 0, NAME_LENGTH_MAX);
-	strcpy(nameKey, key);
+	gma3.keyName(key);
+	}
+
+void keyName(const __FlashStringHelper *key) {
+	gma3.keyName(key);
 	}
 
 void interface(UDP &udp, IPAddress ip, uint16_t port) {
-	ipGma3 = ip;
-	udpGma3 = &udp;
-	portUdpGma3 = port;
-	sendMessage.protocol = UDPOSC;
-	receiveMessage.protocol = UDPOSC;
-	udpGma3->begin(port);
+	gma3.interface(udp, ip, port);
 	}
 
 void interface(Client &tcp, protocol_t protocol, IPAddress ip, uint16_t port) {
-	ipGma3 = ip;
-	tcpGma3 = &tcp;
-	portTcpGma3 = port;
-	sendMessage.protocol = TCP;
-	receiveMessage.protocol = TCP;
-	tcpGma3->connect(ipGma3, port);
+	gma3.interface(tcp, protocol, ip, port);
+	}
+
+int8_t destination(UDP &udp, IPAddress ip, uint16_t port, role_t role) {
+	return gma3.destination(udp, ip, port, role);
+	}
+
+int8_t destination(Client &tcp, IPAddress ip, uint16_t port, role_t role) {
+	return gma3.destination(tcp, ip, port, role);
+	}
+
+void destinationEnable(uint8_t index, bool state) {
+	gma3.destinationEnable(index, state);
+	}
+
+bool destinationHealth(uint8_t index) {
+	return gma3.destinationHealth(index);
+	}
+
+void failover(uint32_t timeout) {
+	gma3.failover(timeout);
+	}
+
+void route(route_t type, protocol_t protocol) {
+	gma3.route(type, protocol);
+	}
+
+protocol_t route(route_t type) {
+	return gma3.route(type);
 	}
 
 void sendOSC() {
-	switch (sendMessage.protocol) {
-		case UDPOSC:
-			udpGma3->beginPacket(ipGma3, portUdpGma3);
-			udpGma3->write(sendMessage.message, sendMessage.size);
-			udpGma3->endPacket();
-			break;
-		case TCP:
-			if (!tcpGma3->connected()) tcpGma3->connect(ipGma3, portTcpGma3);
-			tcpGma3->write(sendMessage.message, sendMessage.size);
-			break;
-		}
+	gma3.sendOSC();
+	}
+
+void bundleBegin(uint64_t timetag) {
+	gma3.bundleBegin(timetag);
+	}
+
+void bundleEnd() {
+	gma3.bundleEnd();
 	}
 
 void command(const char cmd[]) {
-	char pattern[OSC_PATTERN_SIZE];
-	memset(pattern, 0, sizeof(pattern));
-	pattern[0] = '/';
-	if (strlen(namePrefix) != 0) {
-		strcat(pattern, namePrefix);
-		pattern[strlen(pattern)] = '/';
-		}
-	strcat(pattern, "cmd");
-	oscMessage(pattern, cmd);
+	gma3.command(cmd);
 	}
 
 uint16_t commonPool() {
-	return poolCommon;
+	return gma3.commonPool();
 	}
 
 void commonPool(uint16_t pool) {
-	poolCommon = pool;
+	gma3.commonPool(pool);
 	}
 
 uint16_t commonPage() {
-	return pageCommon;
+	return gma3.commonPage();
 	}
 
 void commonPage(uint16_t page) {
-	pageCommon = page;
+	gma3.commonPage(page);
+	}
+
+#if GMA3_STATISTICS
+const struct Statistics& statistics() {
+	return gma3.statistics();
+	}
+
+void statisticsReset() {
+	gma3.statisticsReset();
+	}
+
+void statisticsPublish(const char *address, uint32_t interval) {
+	gma3.statisticsPublish(address, interval);
+	}
+#endif
+
+void oscMessage(const char pattern[], const char string[]) {
+	gma3.oscMessage(pattern, string);
+	}
+
+void oscMessage(const char pattern[], float float32) {
+	gma3.oscMessage(pattern, float32);
+	}
+
+void oscMessage(const char pattern[], int32_t int32) {
+	gma3.oscMessage(pattern, int32);
+	}
+
+void oscMessage(const char pattern[]) {
+	gma3.oscMessage(pattern);
 	}
 
 Parser::Parser(cbptr callback) {
 	this->callback = callback;
 	}
 
+void Parser::attach(Gma3Context &context) {
+	this->context = &context;
+	}
+
 const char* Parser::patternOSC() {
-	return receiveData.pattern + strlen(namePrefixSearch);
+	return receiveData.pattern + context->prefixOffset();
 	}
 
 int Parser::dataStructure(uint8_t level) {
@@ -138,117 +1317,367 @@ const char* Parser::stringOSC() {
 	return receiveData.string;
 	}
 
-int32_t Parser::int1OSC() {
-	return receiveData.int32[0];
+int32_t Parser::int1OSC() {
+	return receiveData.int32[0];
+	}
+
+int32_t Parser::int2OSC() {
+	return receiveData.int32[1];
+	}
+
+float Parser::floatOSC() {
+	return receiveData.float32;
+	}
+
+int8_t Parser::filter(const char *address) {
+	return filter(address, 1, 0);
+	}
+
+int8_t Parser::filter(const char *address, int32_t first, int32_t last) {
+	if (filterCount == FILTER_RULES || !filterSet(filterCount, address, first, last)) return -1;
+	return filterCount++;
+	}
+
+bool Parser::filterChange(uint8_t index, const char *address) {
+	return filterChange(index, address, 1, 0);
+	}
+
+bool Parser::filterChange(uint8_t index, const char *address, int32_t first, int32_t last) {
+	if (index >= filterCount) return false; // only existing filters, filter() adds one
+	return filterSet(index, address, first, last);
+	}
+
+bool Parser::filterSet(uint8_t index, const char *address, int32_t first, int32_t last) {
+	size_t length = strlen(address);
+	if (length >= FILTER_ADDRESS_SIZE) return false;
+	struct Filter &filter = filters[index];
+	memcpy(filter.address, address, length + 1);
+	filter.length = length;
+	filter.first = first;
+	filter.last = last;
+	return true;
 	}
 
-int32_t Parser::int2OSC() {
-	return receiveData.int32[1];
+void Parser::filterClear() {
+	filterCount = 0;
 	}
 
-float Parser::floatOSC() {
-	return receiveData.float32;
+// checks the prefix and the filters, the pattern needs no zero termination,
+// a number cut off by the end of the peeked bytes can't be checked and is accepted
+bool Parser::accept(const char *pattern, int32_t length) {
+	if (!context->prefixCheck(pattern, length)) {
+		STATISTICS_ADD(context, prefixRejects, 1);
+		return false;
+		}
+	if (filterCount == 0) return true;
+	uint8_t offset = context->prefixOffset();
+	const char *address = pattern + offset;
+	int32_t available = length - offset;
+	for (uint8_t i = 0; i < filterCount; i++) {
+		const struct Filter &filter = filters[i];
+		if (available < filter.length || memcmp(address, filter.address, filter.length) != 0) continue;
+		if (filter.first > filter.last) return true; // no range
+		int32_t position = filter.length;
+		int32_t value = 0;
+		uint8_t digits = 0;
+		while (position < available && digits < 9 && address[position] >= '0' && address[position] <= '9') {
+			value = value * 10 + (address[position++] - '0');
+			digits++;
+			}
+		if (position == available) return true; // the rest of the number is not read yet
+		if (digits > 0 && value >= filter.first && value <= filter.last) return true;
+		}
+	STATISTICS_ADD(context, filterRejects, 1);
+	return false;
 	}
 
 void Parser::update() {
-	if(receiveMessage.protocol == UDPOSC) {
-		if(receiveUDP()) {
-			if (callback != nullptr) callback();
-			return;
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_PARSER, this);
+	for (uint8_t i = 0; i < context->destinationCount; i++) {
+		struct Destination &destination = context->destinations[i];
+		if (destination.protocol == UDPOSC) {
+			if (tcpBuffered > 0) continue; // the receive buffer holds a partial TCP message
+			bool shared = false; // a UDP socket can used for several destinations
+			for (uint8_t j = 0; j < i; j++) {
+				if (context->destinations[j].udp == destination.udp) shared = true;
+				}
+			if (shared) continue;
+			if (receiveUDP(*destination.udp)) {
+				if (callback != nullptr) callback();
+				}
 			}
-		}
-	if(receiveMessage.protocol == TCP) {
-		if(receiveTCP()) {
-			if (callback != nullptr) callback();
+		else {
+			if (tcpPending >= 0 && tcpPending != i) continue; // another destination is receiving a message
+			if (tcpPending == i && (!destination.tcp->connected() || millis() - tcpTime > TCP_PARTIAL_TIMEOUT)) { // the rest of the message is lost
+				STATISTICS_ADD(context, parseErrors, 1);
+				tcpOffset = tcpBuffered & 3;
+				tcpResync = i;
+				tcpReset();
+				}
+			if (tcpResync == i && !destination.tcp->connected()) tcpResync = -1; // a new connection starts with a message
+			while (destination.tcp->available() > 0) { // all complete messages, the callback is called for each
+				if (receiveTCP(*destination.tcp, i)) {
+					destination.seen = millis();
+					if (callback != nullptr) callback();
+					}
+				if (tcpPending == i) break; // incomplete, continued by the next update()
+				}
 			}
 		}
 	}
 
-void Parser::parseOSC() {
+// reads a message from the receive buffer and continues with the stream when the buffer is exhausted,
+// bytes read from the stream are kept in the buffer as long as there is space for the capture
+class OscReader {
+	public:
+		OscReader(struct Message &message, Stream &stream, int32_t buffered, int32_t remaining) : message(message), stream(stream) {
+			this->buffered = buffered;
+			this->remaining = remaining;
+			}
+
+		int read() {
+			if (position < buffered) return message.message[position++];
+			if (remaining == 0) return -1;
+			int data = stream.read();
+			if (data < 0) {
+				if (remaining < 0) starved = true; // the rest of a TCP message didn't arrive yet
+				return -1;
+				}
+			if (remaining > 0) remaining--;
+			if (position < message.capacity) message.message[buffered++] = data;
+			position++;
+			return data;
+			}
+
+		// reads a zero terminated string including the padding, a longer string is truncated to the target size
+		bool string(char *target, size_t size) {
+			const uint8_t *begin = message.message + position;
+			const uint8_t *end = position < buffered ? (const uint8_t*)memchr(begin, 0, buffered - position) : nullptr;
+			if (end != nullptr) { // fast path, the string is complete in the buffer
+				size_t length = end - begin;
+				if (length > size - 1) length = size - 1;
+				memcpy(target, begin, length);
+				target[length] = 0;
+				int32_t aligned = (end - message.message + 4) & ~3;
+				if (aligned <= buffered) {
+					position = aligned;
+					return true;
+					}
+				position = buffered;
+				return skip(aligned - buffered); // the padding continues in the stream
+				}
+			size_t length = 0; // OSC_STRING_SIZE can exceed 255
+			int data;
+			while ((data = read()) > 0) {
+				if (length < size - 1) target[length++] = data;
+				}
+			target[length] = 0;
+			return data == 0 && skip((4 - (position & 3)) & 3);
+			}
+
+		bool int32(int32_t &value) {
+			if (position + 4 <= buffered) { // fast path
+				const uint8_t *data = message.message + position;
+				value = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+				position += 4;
+				return true;
+				}
+			uint32_t data = 0;
+			for (uint8_t i = 0; i < 4; i++) {
+				int byte = read();
+				if (byte < 0) return false;
+				data = (data << 8) | byte;
+				}
+			value = data;
+			return true;
+			}
+
+		bool skip(int32_t size) {
+			while (size-- > 0) {
+				if (read() < 0) return false;
+				}
+			return true;
+			}
+
+		int32_t position = 0; // bytes consumed of the message
+		bool starved = false;
+
+	private:
+		struct Message &message;
+		Stream &stream;
+		int32_t buffered; // bytes available in the receive buffer
+		int32_t remaining; // bytes left in the stream, -1 if unknown
+	};
+
+bool Parser::parseOSC(Stream &stream, int32_t buffered, int32_t remaining, bool *starved) {
+	OscReader reader(context->receiveMessage, stream, buffered, remaining);
 	memset(receiveData.pattern, 0, sizeof(receiveData.pattern));
 	memset(receiveData.tag, 0, sizeof(receiveData.tag));
-	memset(receiveData.string, 0, sizeof(receiveData.string)); // what happens with to string
-	*receiveData.int32 = 0;
+	memset(receiveData.string, 0, sizeof(receiveData.string));
+	receiveData.int32[0] = 0;
+	receiveData.int32[1] = 0;
 	receiveData.float32 = 0.0f;
-	int dataStart;
-	strncpy(receiveData.pattern, (char*)receiveMessage.message, sizeof(receiveData.pattern) - 1);
-	sscanf(receiveData.pattern + strlen(namePrefixSearch), "%d.%d.%d.%d.%d", &dataValue[0], &dataValue[1], &dataValue[2], &dataValue[3], &dataValue[4]);
-	int patternSize = strlen(receiveData.pattern);
-	int patternOffset = patternSize % 4;
-	int tagStart;
-	if (patternOffset == 0) tagStart = patternSize + 4;
-	else tagStart = patternSize + (4 - patternOffset);
-	strncpy(receiveData.tag, (char*)receiveMessage.message + tagStart, sizeof(receiveData.tag) - 1);
-	int tagSize = strlen(receiveData.tag); // including ','
-	int tagOffset = tagSize % 4;
-	if (tagOffset == 0) dataStart = tagSize + 4 + tagStart;
-	else dataStart = tagSize + (4 - tagOffset) + tagStart;
-	
-	if (receiveData.tag[1] != 0) {
-		if (receiveData.tag[1] == 's') {
-			strncpy(receiveData.string, (char*)receiveMessage.message + dataStart, sizeof(receiveData.string) - 1);
-			int stringSize = strlen(receiveData.string);
-			int stringOffset = stringSize % 4;
-			if (stringOffset == 0) dataStart = dataStart + stringSize + 4;
-			else dataStart = dataStart + stringSize + (4 - stringOffset);
+	bool complete = reader.string(receiveData.pattern, sizeof(receiveData.pattern));
+	if (complete && receiveData.pattern[0] == '/') complete = reader.string(receiveData.tag, sizeof(receiveData.tag));
+	// the first string, the first two integers and the first float are kept, all other arguments are skipped
+	uint8_t strings = 0;
+	uint8_t integers = 0;
+	uint8_t floats = 0;
+	for (uint8_t i = 1; complete && receiveData.tag[i] != 0; i++) {
+		int32_t value = 0;
+		switch (receiveData.tag[i]) {
+			case 's':
+			case 'S':
+				if (strings++ == 0) complete = reader.string(receiveData.string, sizeof(receiveData.string));
+				else {
+					char skipped[1];
+					complete = reader.string(skipped, sizeof(skipped));
+					}
+				break;
+			case 'i':
+				complete = reader.int32(value);
+				if (integers < 2) receiveData.int32[integers++] = value;
+				break;
+			case 'f':
+				complete = reader.int32(value);
+				if (floats++ == 0) memcpy(&receiveData.float32, &value, sizeof(value));
+				break;
+			case 'b':
+				complete = reader.int32(value) && value >= 0 && (remaining >= 0 || value <= context->receiveMessage.capacity) && reader.skip((value + 3) & ~3);
+				break;
+			case 'c':
+			case 'r':
+			case 'm':
+				complete = reader.skip(4);
+				break;
+			case 'h':
+			case 't':
+			case 'd':
+				complete = reader.skip(8);
+				break;
+			case 'T':
+			case 'F':
+			case 'N':
+			case 'I':
+			case '[':
+			case ']':
+				break;
+			default: // unknown type, the size of the remaining arguments is unknown
+				complete = false;
 			}
 		}
-	else return;
-	
-	if (receiveData.tag[2] != 0) {
-		if (receiveData.tag[2] == 'i') {
-			receiveData.int32[0] = htoi(receiveMessage.message, dataStart);
-			dataStart = dataStart + 4;
-			}
+	context->receiveMessage.size = reader.position;
+	if (starved != nullptr) *starved = reader.starved;
+	if (!complete && !reader.starved) STATISTICS_ADD(context, parseErrors, 1);
+
+	const char *structure = receiveData.pattern + context->prefixOffset();
+	for (uint8_t i = 0; i < 5; i++) { // e.g. 13.13.1.5.201
+		int32_t value = 0;
+		uint8_t length = dtoi(structure, value);
+		if (length == 0) break;
+		dataValue[i] = value;
+		structure += length;
+		if (*structure != '.') break;
+		structure++;
 		}
-	else return;
+	return complete;
+	}
 
-	if (receiveData.tag[3] != 0) {
-		if (receiveData.tag[3] == 'i') {
-			receiveData.int32[1] = htoi(receiveMessage.message, dataStart);
-			dataStart = dataStart + 4;
+bool Parser::receiveUDP(UDP &udp) {
+	int32_t size = udp.parsePacket();
+	if (size > 0) {
+		context->activity();
+		context->receiveMessage.protocol = UDPOSC;
+		STATISTICS_ADD(context, packetsReceived, 1);
+		STATISTICS_ADD(context, bytesReceived, size);
+		uint32_t ip = udp.remoteIP();
+		for (uint8_t i = 0; i < context->destinationCount; i++) { // health check for failover
+			if (context->destinations[i].udp == &udp && context->destinations[i].ip == ip) context->destinations[i].seen = millis();
 			}
-		else if (receiveData.tag[3] == 'f') {
-			receiveData.float32 = htof(receiveMessage.message, dataStart);
-			dataStart = dataStart + 4;
+		// the buffer takes the packet or its begin, the rest is parsed from the stream
+		int32_t buffered = size < context->receiveMessage.capacity ? size : context->receiveMessage.capacity;
+		// with filters only the begin is read for the check, a rejected packet is neither copied nor parsed,
+		// the next parsePacket() discards it, a capture needs the whole packet
+		int32_t peek = filterCount > 0 && context->captureOutput == nullptr && buffered > OSC_PEEK_SIZE ? OSC_PEEK_SIZE : buffered;
+		peek = udp.read(context->receiveMessage.message, peek);
+		if (peek < 0) peek = 0;
+		context->receiveMessage.size = size;
+		if (size > context->receiveMessage.capacity) STATISTICS_ADD(context, oversizedReceives, 1);
+		else if (context->captureOutput != nullptr) context->captureFrame(CAPTURE_RECEIVED, context->receiveMessage.message, peek);
+		if (!accept((const char*)context->receiveMessage.message, peek)) return false;
+		if (peek < buffered) {
+			int32_t rest = udp.read(context->receiveMessage.message + peek, buffered - peek);
+			if (rest > 0) peek += rest;
 			}
+		parseOSC(udp, peek, size - peek);
+		context->receiveMessage.size = size;
+		return true;
 		}
+	return false;
 	}
 
-bool Parser::receiveUDP() {
-	size_t size = udpGma3->parsePacket();
-	if (size > 0) {
-		receiveMessage.size = size;
-		memset(receiveMessage.message, 0, OSC_MESSAGE_SIZE);
-		if (size <= sizeof(receiveMessage.message)) {
-			udpGma3->read(receiveMessage.message, size);
-			if (strlen(namePrefix) != 0) {
-				if (memcmp(receiveMessage.message, namePrefixSearch, strlen(namePrefixSearch)) != 0) return false;
-				}
-			parseOSC();
-			return true;
+// TCP has no framing, the end of a message is found by parsing it, messages which arrive together are handled one by one,
+// the begin of a message split into several segments is kept in the receive buffer and parsed again with the next segment
+bool Parser::receiveTCP(Client &tcp, uint8_t index) {
+	if (tcp.available() <= 0) return false;
+	context->activity();
+	if (tcpPending < 0 && tcpResync != (int8_t)index && tcp.peek() != '/') { // no message begins here, e.g. the rest of a lost message
+		STATISTICS_ADD(context, parseErrors, 1);
+		tcpResync = index;
+		tcpOffset = 0;
+		}
+	if (tcpResync == (int8_t)index && !tcpSkip(tcp)) return false;
+	context->receiveMessage.protocol = TCP;
+	bool starved = false;
+	bool complete = parseOSC(tcp, tcpBuffered, -1, &starved);
+	int32_t size = context->receiveMessage.size;
+	if (starved) {
+		if (size <= context->receiveMessage.capacity) { // continued by the next update()
+			tcpPending = index;
+			tcpBuffered = size;
+			tcpTime = millis();
+			return false;
 			}
+		STATISTICS_ADD(context, oversizedReceives, 1); // the begin of a message larger than the receive buffer is lost
+		STATISTICS_ADD(context, parseErrors, 1);
+		tcpReset();
+		tcpResync = index;
+		tcpOffset = size & 3;
+		return false;
 		}
-	return false;
+	tcpReset();
+	STATISTICS_ADD(context, packetsReceived, 1);
+	STATISTICS_ADD(context, bytesReceived, size);
+	if (size > context->receiveMessage.capacity) STATISTICS_ADD(context, oversizedReceives, 1);
+	else if (context->captureOutput != nullptr) context->captureFrame(CAPTURE_RECEIVED | CAPTURE_TCP, context->receiveMessage.message, size);
+	if (!complete) { // the end of a malformed message is unknown
+		tcpResync = index;
+		tcpOffset = size & 3;
+		return false;
+		}
+	return accept(receiveData.pattern, strlen(receiveData.pattern));
 	}
 
-bool Parser::receiveTCP() {
-	size_t size = tcpGma3->available();
-	if (size > 0) {
-		receiveMessage.size = size;
-		memset(receiveMessage.message, 0, OSC_MESSAGE_SIZE);
-		if (size <= sizeof(receiveMessage.message)) {
-			tcpGma3->read(receiveMessage.message, size);
-			if (strlen(namePrefix) != 0) {
-				if (memcmp(receiveMessage.message, namePrefixSearch, strlen(namePrefixSearch)) != 0) return false;
-				}
-			parseOSC();
+// skips the rest of a lost message, the next message begins with '/' at a multiple of 4 bytes
+bool Parser::tcpSkip(Client &tcp) {
+	int data;
+	while ((data = tcp.peek()) >= 0) {
+		if (data == '/' && tcpOffset == 0) {
+			tcpResync = -1;
 			return true;
 			}
+		tcp.read();
+		tcpOffset = (tcpOffset + 1) & 3;
 		}
 	return false;
 	}
 
+void Parser::tcpReset() {
+	tcpPending = -1;
+	tcpBuffered = 0;
+	}
+
 Pools::Pools(uint8_t pinUp, uint8_t pinDown, uint8_t poolsStart, uint8_t poolsEnd, send_t mode, cbptr callback) {
 	this->pinUp = pinUp;
 	pinMode(pinUp, INPUT_PULLUP);
@@ -261,7 +1690,6 @@ Pools::Pools(uint8_t pinUp, uint8_t pinDown, uint8_t poolsStart, uint8_t poolsEn
 	this->callback = callback;
 	this->mode = mode;
 	poolNumber = poolsStart;
-	poolCommon = poolsStart;
 	}
 
 Pools::Pools(uint8_t poolsStart, uint8_t poolsEnd, send_t mode, cbptr callback) {
@@ -270,11 +1698,16 @@ Pools::Pools(uint8_t poolsStart, uint8_t poolsEnd, send_t mode, cbptr callback)
 	this->callback = callback;
 	this->mode = mode;
 	poolNumber = poolsStart;
-	poolCommon = poolsStart;
+	}
+
+void Pools::attach(Gma3Context &context) {
+	this->context = &context;
+	context.poolCommon = poolNumber;
+	published = true;
 	}
 
 uint16_t Pools::currentPool() {
-	return poolCommon;
+	return context->poolCommon;
 	}
 
 uint16_t Pools::lastPool() {
@@ -282,6 +1715,11 @@ uint16_t Pools::lastPool() {
 	}
 
 void Pools::update() {
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_PAGES_POOLS, this);
+	if (context->poolCommon >= poolsStart && context->poolCommon <= poolsEnd) poolNumber = context->poolCommon; // continue from a pool set by commonPool() or a snapshot
+	else if (!published) context->poolCommon = poolNumber; // without attach() the first pool is set by the first update
+	published = true;
 	if (digitalRead(pinUp) != pinUpLast) {
 		if (pinUpLast == false) {
 			pinUpLast = true; // button release
@@ -291,9 +1729,7 @@ void Pools::update() {
 			poolLast = poolNumber;
 			if (poolNumber >= poolsEnd) poolNumber = poolsStart; // rollover to first page
 			else poolNumber++;
-			if(mode == GLOBAL || mode == CONSOLE) sendPool(poolNumber);
-			poolCommon = poolNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		return;
 		}
@@ -306,24 +1742,24 @@ void Pools::update() {
 			poolLast = poolNumber;
 			if (poolNumber <= poolsStart) poolNumber = poolsEnd; // rollover to last page
 			else poolNumber--;
-			if(mode == GLOBAL || mode == CONSOLE) sendPool(poolNumber);
-			poolCommon = poolNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		return;
 		}
 	}
 
 void Pools::update(bool stateUp, bool stateDown) {
+	PROFILE_SCOPE(context, PROFILE_PAGES_POOLS, this);
+	if (context->poolCommon >= poolsStart && context->poolCommon <= poolsEnd) poolNumber = context->poolCommon; // continue from a pool set by commonPool() or a snapshot
+	else if (!published) context->poolCommon = poolNumber; // without attach() the first pool is set by the first update
+	published = true;
 	if (stateUp != pinUpLast) {
 		if (pinUpLast == false) {
 			pinUpLast = true; // button press
 			poolLast = poolNumber;
 			if (poolNumber >= poolsEnd) poolNumber = poolsStart; // rollover to first page
 			else poolNumber++;
-			if(mode == GLOBAL || mode == CONSOLE) sendPool(poolNumber);
-			poolCommon = poolNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		else { // button release
 			pinUpLast = false;
@@ -336,9 +1772,7 @@ void Pools::update(bool stateUp, bool stateDown) {
 			poolLast = poolNumber;
 			if (poolNumber <= poolsStart) poolNumber = poolsEnd; // rollover to last page
 			else poolNumber--;
-			if(mode == GLOBAL || mode == CONSOLE) sendPool(poolNumber);
-			poolCommon = poolNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		else { // button release
 			pinDownLast = false;
@@ -347,10 +1781,30 @@ void Pools::update(bool stateUp, bool stateDown) {
 		}
 	}
 
+void Pools::resync(bool state) {
+	resyncState = state;
+	}
+
+void Pools::change() {
+	if(mode == GLOBAL || mode == CONSOLE) sendPool(poolNumber);
+	context->poolCommon = poolNumber;
+	if (callback != nullptr) callback(); // execute callback
+	if (resyncState) context->resync(false); // after callback, fetch() can lock faders
+	}
+
+void Pools::address(const char *address) {
+	memset(addressString, 0, NAME_LENGTH_MAX);
+	strncpy(addressString, address, NAME_LENGTH_MAX - 1);
+	}
+
 void Pools::sendPool(uint16_t pool) {
-	char cmd[12] = "dataPool ";
-	strcat(cmd, itoa(pool));
-	command(cmd);
+	if (strlen(addressString)) {
+		context->sendAddress(addressString, pool);
+		return;
+		}
+	char cmd[NAME_LENGTH_MAX] = "dataPool ";
+	itod(cmd + strlen(cmd), pool);
+	context->command(cmd);
 	}
 
 Pages::Pages(uint8_t pinUp, uint8_t pinDown, uint8_t pagesStart, uint8_t pagesEnd, send_t mode, cbptr callback) {
@@ -364,8 +1818,8 @@ Pages::Pages(uint8_t pinUp, uint8_t pinDown, uint8_t pagesStart, uint8_t pagesEn
 	this->pagesEnd = pagesEnd;
 	this->mode = mode;
 	this->callback = callback;
+	pageNumber = pagesStart;
 	pageLast = pagesStart;
-	pageCommon = pagesStart;
 	}
 
 Pages::Pages(uint8_t pagesStart, uint8_t pagesEnd, send_t mode, cbptr callback) {
@@ -373,12 +1827,18 @@ Pages::Pages(uint8_t pagesStart, uint8_t pagesEnd, send_t mode, cbptr callback)
 	this->pagesEnd = pagesEnd;
 	this->mode = mode;
 	this->callback = callback;
+	pageNumber = pagesStart;
 	pageLast = pagesStart;
-	pageCommon = pagesStart;
+	}
+
+void Pages::attach(Gma3Context &context) {
+	this->context = &context;
+	context.pageCommon = pageNumber;
+	published = true;
 	}
 
 uint16_t Pages::currentPage() {
-	return pageCommon;
+	return context->pageCommon;
 	}
 
 uint16_t Pages::lastPage() {
@@ -386,6 +1846,11 @@ uint16_t Pages::lastPage() {
 	}
 
 void Pages::update() {
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_PAGES_POOLS, this);
+	if (context->pageCommon >= pagesStart && context->pageCommon <= pagesEnd) pageNumber = context->pageCommon; // continue from a page set by commonPage() or a snapshot
+	else if (!published) context->pageCommon = pageNumber; // without attach() the first page is set by the first update
+	published = true;
 	if (digitalRead(pinUp) != pinUpLast) {
 		if (pinUpLast == false) {
 			pinUpLast = true; // button release
@@ -395,9 +1860,7 @@ void Pages::update() {
 			pageLast = pageNumber;
 			if (pageNumber >= pagesEnd) pageNumber = pagesStart; // rollover to first page
 			else pageNumber++;
-			if(mode == GLOBAL || mode == CONSOLE) sendPage(pageNumber);
-			pageCommon = pageNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		return;
 		}
@@ -410,24 +1873,24 @@ void Pages::update() {
 			pageLast = pageNumber;
 			if (pageNumber <= pagesStart) pageNumber = pagesEnd; // rollover to last page
 			else pageNumber--;
-			if(mode == GLOBAL || mode == CONSOLE) sendPage(pageNumber);
-			pageCommon = pageNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		return;
 		}
 	}
 
 void Pages::update(bool stateUp, bool stateDown) {
+	PROFILE_SCOPE(context, PROFILE_PAGES_POOLS, this);
+	if (context->pageCommon >= pagesStart && context->pageCommon <= pagesEnd) pageNumber = context->pageCommon; // continue from a page set by commonPage() or a snapshot
+	else if (!published) context->pageCommon = pageNumber; // without attach() the first page is set by the first update
+	published = true;
 	if (stateUp != pinUpLast) {
 		if (pinUpLast == false) {
 			pinUpLast = true; // button press
 			pageLast = pageNumber;
 			if (pageNumber >= pagesEnd) pageNumber = pagesStart; // rollover to first page
 			else pageNumber++;
-			if(mode == GLOBAL || mode == CONSOLE) sendPage(pageNumber);
-			pageCommon = pageNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		else { // button release
 			pinUpLast = false;
@@ -440,9 +1903,7 @@ void Pages::update(bool stateUp, bool stateDown) {
 			pageLast = pageNumber;
 			if (pageNumber <= pagesStart) pageNumber = pagesEnd; // rollover to last page
 			else pageNumber--;
-			if(mode == GLOBAL || mode == CONSOLE) sendPage(pageNumber);
-			pageCommon = pageNumber;
-			if (callback != nullptr) callback(); // execute callback
+			change();
 			}
 		else { // button release
 			pinDownLast = false;
@@ -451,13 +1912,34 @@ void Pages::update(bool stateUp, bool stateDown) {
 		}
 	}
 
+void Pages::resync(bool state) {
+	resyncState = state;
+	}
+
+void Pages::change() {
+	if(mode == GLOBAL || mode == CONSOLE) sendPage(pageNumber);
+	context->pageCommon = pageNumber;
+	if (callback != nullptr) callback(); // execute callback
+	if (resyncState) context->resync(true); // after callback, fetch() can lock faders
+	}
+
+void Pages::address(const char *address) {
+	memset(addressString, 0, NAME_LENGTH_MAX);
+	strncpy(addressString, address, NAME_LENGTH_MAX - 1);
+	}
+
 void Pages::sendPage(uint16_t page) {
-	char cmd[12] = "Page ";
-	strcat(cmd, itoa(page));
-	command(cmd);
+	if (strlen(addressString)) {
+		context->sendAddress(addressString, page);
+		return;
+		}
+	char cmd[NAME_LENGTH_MAX] = "Page ";
+	itod(cmd + strlen(cmd), page);
+	context->command(cmd);
 	}
 
 Key::Key(uint8_t pin, uint16_t key) {
+	link();
 	this->pin = pin;
 	pinMode(pin, INPUT_PULLUP);
 	last = HIGH;
@@ -465,9 +1947,39 @@ Key::Key(uint8_t pin, uint16_t key) {
 	}
 
 Key::Key(uint16_t key) {
+	link();
 	this->key = key;
 	}
 
+// a copy, e.g. of an array initializer, is a control of its own
+Key::Key(const Key &key) : context(key.context), pin(key.pin), last(key.last), key(key.key), poolLocal(key.poolLocal), pageLocal(key.pageLocal) {
+	link();
+	}
+
+Key::~Key() {
+	unlink();
+	}
+
+void Key::attach(Gma3Context &context) {
+	unlink();
+	this->context = &context;
+	link();
+	}
+
+void Key::link() {
+	keyNext = context->keyList;
+	context->keyList = this;
+	}
+
+void Key::unlink() {
+	for (Key **key = &context->keyList; *key != nullptr; key = &(*key)->keyNext) {
+		if (*key == this) {
+			*key = keyNext;
+			break;
+			}
+		}
+	}
+
 void Key::pool(uint16_t poolLocal) {
 	this->poolLocal = poolLocal;
 	}
@@ -477,74 +1989,50 @@ void Key::page(uint16_t pageLocal) {
 	}
 
 void Key::update() {
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_KEY, this);
 	if ((digitalRead(pin)) != last) {
+#if GMA3_LATENCY
+		context->latencyBegin(ROUTE_KEY);
+#endif
 		char pattern[OSC_PATTERN_SIZE];
-		memset(pattern, 0, sizeof(pattern));
-		pattern[0] = '/';
-		if (strlen(namePrefix)) {
-			strcat(pattern, namePrefix);
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePool)) {
-			strcat(pattern, namePool);
-			if (poolLocal > 0) strcat(pattern, itoa(poolLocal));
-			else strcat(pattern, itoa(poolCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePage)) {
-			strcat(pattern, namePage);
-			if (pageLocal > 0) strcat(pattern, itoa(pageLocal));
-			else strcat(pattern, itoa(pageCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		strcat(pattern, nameKey);
-		strcat(pattern, itoa(key));
+		context->patternExecutor(pattern, NAME_KEY, poolLocal, pageLocal, key);
 		if (last == LOW) {
 			last = HIGH;
-			oscMessage(pattern, BUTTON_RELEASE);
+			context->routeMessage(ROUTE_KEY);
+			context->oscMessage(pattern, BUTTON_RELEASE);
 			}
 		else {
 			last = LOW;
-			oscMessage(pattern, BUTTON_PRESS);
+			context->routeMessage(ROUTE_KEY);
+			context->oscMessage(pattern, BUTTON_PRESS);
 			}
 		} 
 	}
 
 void Key::update(bool state) {
+	PROFILE_SCOPE(context, PROFILE_KEY, this);
 	if (state != last) {
+#if GMA3_LATENCY
+		context->latencyBegin(ROUTE_KEY);
+#endif
 		char pattern[OSC_PATTERN_SIZE];
-		memset(pattern, 0, sizeof(pattern));
-		pattern[0] = '/';
-		if (strlen(namePrefix)) {
-			strcat(pattern, namePrefix);
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePool)) {
-			strcat(pattern, namePool);
-			if (poolLocal > 0) strcat(pattern, itoa(poolLocal));
-			else strcat(pattern, itoa(poolCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePage)) {
-			strcat(pattern, namePage);
-			if (pageLocal > 0) strcat(pattern, itoa(pageLocal));
-			else strcat(pattern, itoa(pageCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		strcat(pattern, nameKey);
-		strcat(pattern, itoa(key));
+		context->patternExecutor(pattern, NAME_KEY, poolLocal, pageLocal, key);
 		if (last == LOW) {
 			last = HIGH;
-			oscMessage(pattern, BUTTON_PRESS);
+			context->routeMessage(ROUTE_KEY);
+			context->oscMessage(pattern, BUTTON_PRESS);
 			}
 		else {
 			last = LOW;
-			oscMessage(pattern, BUTTON_RELEASE);
+			context->routeMessage(ROUTE_KEY);
+			context->oscMessage(pattern, BUTTON_RELEASE);
 			}
 		} 
 	}
 
 Fader::Fader(uint8_t analogPin, uint16_t fader) {
+	link();
 	this->analogPin = analogPin;
 	this->fader = fader;
 	analogLast = 0xFFFF; // forces an receiveData output of the fader
@@ -552,11 +2040,43 @@ Fader::Fader(uint8_t analogPin, uint16_t fader) {
 	}
 
 Fader::Fader(uint16_t fader) {
+	link();
 	this->fader = fader;
 	analogLast = 0xFFFF; // forces an receiveData output of the fader
 	updateTime = millis();
 	}
 
+// a copy, e.g. of an array initializer, is a control of its own
+Fader::Fader(const Fader &fader) : context(fader.context), lockState(fader.lockState), sendPending(fader.sendPending), analogPin(fader.analogPin),
+	delta(fader.delta), fader(fader.fader), poolLocal(fader.poolLocal), pageLocal(fader.pageLocal), fetchValue(fader.fetchValue),
+	analogLast(fader.analogLast), valueLast(fader.valueLast), updateTime(fader.updateTime) {
+	link();
+	}
+
+Fader::~Fader() {
+	unlink();
+	}
+
+void Fader::attach(Gma3Context &context) {
+	unlink();
+	this->context = &context;
+	link();
+	}
+
+void Fader::link() {
+	faderNext = context->faderList;
+	context->faderList = this;
+	}
+
+void Fader::unlink() {
+	for (Fader **fader = &context->faderList; *fader != nullptr; fader = &(*fader)->faderNext) {
+		if (*fader == this) {
+			*fader = faderNext;
+			break;
+			}
+		}
+	}
+
 void Fader::pool(uint16_t poolLocal) {
 	this->poolLocal = poolLocal;
 	}
@@ -587,88 +2107,71 @@ void Fader::lock(bool state) {
 	}
 
 void Fader::update() {
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_FADER, this);
 	if ((updateTime + FADER_UPDATE_RATE_MS) < millis()) {
-		int16_t raw = analogRead(analogPin) >> 2;
+		int16_t raw;
+		{
+			PROFILE_SCOPE(context, PROFILE_ANALOG, nullptr);
+			raw = analogRead(analogPin) >> 2;
+			}
 		if (raw < (analogLast - FADER_THRESHOLD) || raw > (analogLast + FADER_THRESHOLD)) {
   	  analogLast = raw;
+#if GMA3_LATENCY
+			context->latencyBegin(ROUTE_FADER);
+#endif
 			int32_t value = map(analogLast, FADER_THRESHOLD, 255 - FADER_THRESHOLD, 0, 100); // convert to 0...100
   	  if (valueLast != value) {
   	    valueLast = value;
 				if (lockState == true) {
 					if ((valueLast <= fetchValue + delta) && (valueLast >= fetchValue - delta)) lockState = false; 
 					}
-				if (lockState == false) {
-					char pattern[OSC_PATTERN_SIZE];
-					memset(pattern, 0, sizeof(pattern));
-					pattern[0] = '/';
-					if (strlen(namePrefix)) {
-						strcat(pattern, namePrefix);
-						pattern[strlen(pattern)] = '/';
-						}
-					if(strlen(namePool)) {
-						strcat(pattern, namePool);
-						if (poolLocal > 0) strcat(pattern, itoa(poolLocal));
-						else strcat(pattern, itoa(poolCommon));
-						pattern[strlen(pattern)] = '/';
-						}
-					if(strlen(namePage)) {
-						strcat(pattern, namePage);
-						if (pageLocal > 0) strcat(pattern, itoa(pageLocal));
-						else strcat(pattern, itoa(pageCommon));
-						pattern[strlen(pattern)] = '/';
-						}
-					strcat(pattern, nameFader);
-					strcat(pattern, itoa(fader));
-					oscMessage(pattern, value);
-					}
+				if (lockState == false) sendPending = true;
   	  	}
 			}
 		updateTime = millis();
 		}
+	if (sendPending && context->rateCheck(ROUTE_FADER)) send();
 	}
 
 void Fader::update(uint16_t analog) {
+	PROFILE_SCOPE(context, PROFILE_FADER, this);
 	if ((updateTime + FADER_UPDATE_RATE_MS) < millis()) {
 		int16_t raw = analog >> 2;
   	if (raw < (analogLast - FADER_THRESHOLD) || raw > (analogLast + FADER_THRESHOLD)) {
   	  analogLast = raw;
+#if GMA3_LATENCY
+			context->latencyBegin(ROUTE_FADER);
+#endif
   	  int32_t value = map(analogLast, FADER_THRESHOLD, 255 - FADER_THRESHOLD, 0, 100); // convert to 0...100
   	  if (valueLast != value) {
   	    valueLast = value;
 				if (lockState == true) {
 					if ((valueLast <= fetchValue + delta) && (valueLast >= fetchValue - delta)) lockState = false; 
 					}
-				if (lockState == false) {
-					char pattern[OSC_PATTERN_SIZE];
-					memset(pattern, 0, sizeof(pattern));
-					pattern[0] = '/';
-					if (strlen(namePrefix)) {
-						strcat(pattern, namePrefix);
-						pattern[strlen(pattern)] = '/';
-						}
-					if(strlen(namePool)) {
-						strcat(pattern, namePool);
-						if (poolLocal > 0) strcat(pattern, itoa(poolLocal));
-						else strcat(pattern, itoa(poolCommon));
-						pattern[strlen(pattern)] = '/';
-						}
-					if(strlen(namePage)) {
-						strcat(pattern, namePage);
-						if (pageLocal > 0) strcat(pattern, itoa(pageLocal));
-						else strcat(pattern, itoa(pageCommon));
-						pattern[strlen(pattern)] = '/';
-						}
-					strcat(pattern, nameFader);
-					strcat(pattern, itoa(fader));
-					oscMessage(pattern, value);
-					}
+				if (lockState == false) sendPending = true;
   	  	}
 			}
 		updateTime = millis();
 		}	
+	if (sendPending && context->rateCheck(ROUTE_FADER)) send();
+	}
+
+void Fader::resync(bool page) {
+	gma3.resync(page);
+	}
+
+void Fader::send() {
+	sendPending = false;
+	char pattern[OSC_PATTERN_SIZE];
+	context->patternExecutor(pattern, NAME_FADER, poolLocal, pageLocal, fader);
+	context->routeMessage(ROUTE_FADER);
+	context->oscMessage(pattern, valueLast);
+	if (context->recorder != nullptr) context->recorder->add(fader, valueLast);
 	}
 
 ExecutorKnob::ExecutorKnob(uint8_t pinA, uint8_t pinB, uint16_t executorKnob, uint8_t direction) {
+	link();
 	this->pinA = pinA;
 	this->pinB = pinB;
 	pinMode(pinA, INPUT_PULLUP);
@@ -678,10 +2181,42 @@ ExecutorKnob::ExecutorKnob(uint8_t pinA, uint8_t pinB, uint16_t executorKnob, ui
 	}
 
 ExecutorKnob::ExecutorKnob(uint16_t executorKnob, uint8_t direction) {
+	link();
 	this->direction = direction;
 	this->executorKnob = executorKnob;
 	}
 
+// a copy, e.g. of an array initializer, is a control of its own
+ExecutorKnob::ExecutorKnob(const ExecutorKnob &knob) : context(knob.context), pinA(knob.pinA), pinB(knob.pinB), pinALast(knob.pinALast),
+	pinACurrent(knob.pinACurrent), direction(knob.direction), value(knob.value), encoderMotion(knob.encoderMotion),
+	encoderPending(knob.encoderPending), executorKnob(knob.executorKnob), poolLocal(knob.poolLocal), pageLocal(knob.pageLocal) {
+	link();
+	}
+
+ExecutorKnob::~ExecutorKnob() {
+	unlink();
+	}
+
+void ExecutorKnob::attach(Gma3Context &context) {
+	unlink();
+	this->context = &context;
+	link();
+	}
+
+void ExecutorKnob::link() {
+	executorKnobNext = context->executorKnobList;
+	context->executorKnobList = this;
+	}
+
+void ExecutorKnob::unlink() {
+	for (ExecutorKnob **knob = &context->executorKnobList; *knob != nullptr; knob = &(*knob)->executorKnobNext) {
+		if (*knob == this) {
+			*knob = executorKnobNext;
+			break;
+			}
+		}
+	}
+
 void ExecutorKnob::pool(uint16_t poolLocal) {
 	this->poolLocal = poolLocal;
 	}
@@ -692,6 +2227,8 @@ void ExecutorKnob::page(uint16_t pageLocal) {
 
 void ExecutorKnob::update() {
 	encoderMotion = 0;
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_EXECUTOR_KNOB, this);
 	pinACurrent = digitalRead(pinA);	
 	if ((pinALast) && (!pinACurrent)) {
 		if (digitalRead(pinB)) {
@@ -704,32 +2241,16 @@ void ExecutorKnob::update() {
 		}
 	pinALast = pinACurrent;
 	if (encoderMotion != 0) {
-		char pattern[OSC_PATTERN_SIZE];
-		memset(pattern, 0, sizeof(pattern));
-		pattern[0] = '/';
-		if (strlen(namePrefix)) {
-			strcat(pattern, namePrefix);
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePool)) {
-			strcat(pattern, namePool);
-			if (poolLocal > 0) strcat(pattern, itoa(poolLocal));
-			else strcat(pattern, itoa(poolCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePage)) {
-			strcat(pattern, namePage);
-			if (pageLocal > 0) strcat(pattern, itoa(pageLocal));
-			else strcat(pattern, itoa(pageCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		strcat(pattern, nameExecutorKnob);
-		strcat(pattern, itoa(executorKnob));
-		oscMessage(pattern, (int32_t)encoderMotion);
+#if GMA3_LATENCY
+		context->latencyBegin(ROUTE_EXECUTOR_KNOB);
+#endif
+		encoderPending += encoderMotion;
 		}
+	if (encoderPending != 0 && context->rateCheck(ROUTE_EXECUTOR_KNOB)) send();
 	}
 
 void ExecutorKnob::update(uint8_t stateA, uint8_t stateB) {
+	PROFILE_SCOPE(context, PROFILE_EXECUTOR_KNOB, this);
 	encoderMotion = 0;
 	pinACurrent = stateA;	
 	if ((pinALast) && (!pinACurrent)) {
@@ -743,75 +2264,76 @@ void ExecutorKnob::update(uint8_t stateA, uint8_t stateB) {
 		}
 	pinALast = pinACurrent;
 	if (encoderMotion != 0) {
-		char pattern[OSC_PATTERN_SIZE];
-		memset(pattern, 0, sizeof(pattern));
-		pattern[0] = '/';
-		if (strlen(namePrefix)) {
-			strcat(pattern, namePrefix);
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePool)) {
-			strcat(pattern, namePool);
-			if (poolLocal > 0) strcat(pattern, itoa(poolLocal));
-			else strcat(pattern, itoa(poolCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		if(strlen(namePage)) {
-			strcat(pattern, namePage);
-			if (pageLocal > 0) strcat(pattern, itoa(pageLocal));
-			else strcat(pattern, itoa(pageCommon));
-			pattern[strlen(pattern)] = '/';
-			}
-		strcat(pattern, nameExecutorKnob);
-		strcat(pattern, itoa(executorKnob));
-		oscMessage(pattern, (int32_t)encoderMotion);
+#if GMA3_LATENCY
+		context->latencyBegin(ROUTE_EXECUTOR_KNOB);
+#endif
+		encoderPending += encoderMotion;
 		}
+	if (encoderPending != 0 && context->rateCheck(ROUTE_EXECUTOR_KNOB)) send();
+	}
+
+void ExecutorKnob::send() {
+	char pattern[OSC_PATTERN_SIZE];
+	context->patternExecutor(pattern, NAME_EXECUTOR_KNOB, poolLocal, pageLocal, executorKnob);
+	context->routeMessage(ROUTE_EXECUTOR_KNOB);
+	context->oscMessage(pattern, (int32_t)encoderPending); // the deferred steps are sent at once
+	encoderPending = 0;
 	}
 
 CmdButton::CmdButton(uint8_t pin, const char *command) {
 	this->pin = pin;
 	pinMode(pin, INPUT_PULLUP);
 	last = HIGH;
-	strncpy(cmdString, command, OSC_STRING_SIZE - 1);
+	this->command = command;
+	}
+
+CmdButton::CmdButton(uint8_t pin, const __FlashStringHelper *command) {
+	this->pin = pin;
+	pinMode(pin, INPUT_PULLUP);
+	last = HIGH;
+	this->command = (const char*)command;
+	flash = true;
 	}
 
 CmdButton::CmdButton(const char *command) {
-	strncpy(cmdString, command, OSC_STRING_SIZE - 1);
+	this->command = command;
+	}
+
+CmdButton::CmdButton(const __FlashStringHelper *command) {
+	this->command = (const char*)command;
+	flash = true;
+	}
+
+void CmdButton::attach(Gma3Context &context) {
+	this->context = &context;
 	}
 
 void CmdButton::update() {
+	if (!context->scanning()) return;
+	PROFILE_SCOPE(context, PROFILE_CMD_BUTTON, this);
 	if ((digitalRead(pin)) != last) {
 		if (last == LOW) {
 			last = HIGH;
 			}
 		else {
 			last = LOW;
-			char pattern[OSC_PATTERN_SIZE];
-			memset(pattern, 0, sizeof(pattern));
-			pattern[0] = '/';
-			if (strlen(namePrefix)) {
-				strcat(pattern, namePrefix);
-				strcat(pattern, "/");
-				}
-			strcat(pattern, "cmd");
-			oscMessage(pattern, cmdString);
+#if GMA3_LATENCY
+			context->latencyBegin(ROUTE_COMMAND);
+#endif
+			send();
 			}
 		}
 	}
 
 void CmdButton::update(bool state) {
+	PROFILE_SCOPE(context, PROFILE_CMD_BUTTON, this);
 	if (state != last) {
 		if (last == LOW) {
 			last = HIGH;
-			char pattern[OSC_PATTERN_SIZE];
-			memset(pattern, 0, sizeof(pattern));
-			pattern[0] = '/';
-			if (strlen(namePrefix)) {
-				strcat(pattern, namePrefix);
-				strcat(pattern, "/");
-				}
-			strcat(pattern, "cmd");
-			oscMessage(pattern, cmdString);
+#if GMA3_LATENCY
+			context->latencyBegin(ROUTE_COMMAND);
+#endif
+			send();
 			}
 		else {
 			last = LOW;
@@ -819,69 +2341,298 @@ void CmdButton::update(bool state) {
 		}
 	}
 
-void oscMessage(const char pattern[], const char string[]) {
-	memset(sendMessage.message, 0, sizeof(sendMessage.message));
-	sendMessage.size = 0;
-	int patternLength = strlen(pattern);
-	int stringLength = strlen(string);
-	memcpy(sendMessage.message, pattern, patternLength);
-	int patternOffset = patternLength % 4;
-	int tagStart;
-	if (patternOffset == 0) tagStart = patternLength + 4;
-	else tagStart = patternLength + (4 - patternOffset);
-	memcpy(sendMessage.message + tagStart, ",s\0\0", 4);
-	int stringStart = tagStart + 4;
-	memcpy(sendMessage.message + stringStart, string, stringLength);
-	int stringOffset = stringLength % 4;
-	if (stringOffset == 0) sendMessage.size = stringStart + stringLength + 4;
-	else sendMessage.size = stringStart + stringLength + (4 - stringOffset);
-	sendOSC();
+void CmdButton::send() {
+#if GMA3_MACROS
+	for (const char *position = command; ; position++) { // several lines are a macro sequence
+		char data = flash ? pgm_read_byte(position) : *position;
+		if (data == 0) break;
+		if (data == MACRO_SEPARATOR) {
+			context->macroStart(command, flash, this);
+			return;
+			}
+		}
+#endif
+	if (flash) {
+		char cmd[OSC_STRING_SIZE];
+		strncpy_P(cmd, command, sizeof(cmd) - 1);
+		cmd[sizeof(cmd) - 1] = 0;
+		context->command(cmd);
+		}
+	else context->command(command);
 	}
 
-void oscMessage(const char pattern[], float float32) {
-	memset(sendMessage.message, 0, sizeof(sendMessage.message));
-	sendMessage.size = 0;
-	int patternLength = strlen(pattern);
-	memcpy(sendMessage.message, pattern, patternLength);
-	int patternOffset = patternLength % 4;
-	int tagStart;
-	if (patternOffset == 0) tagStart = patternLength + 4;
-	else tagStart = patternLength + (4 - patternOffset);
-	memcpy(sendMessage.message + tagStart, ",f\0\0", 4);
-	int dataStart = tagStart + 4;
-	ftoh(sendMessage.message, dataStart, float32);
-	sendMessage.size = dataStart + 4;
-	sendOSC();
+// unsigned LEB128, 7 bits per byte, the high bit marks a following byte
+static uint8_t varintWrite(uint8_t *target, uint32_t value) {
+	uint8_t size = 0;
+	while (value > 0x7F) {
+		target[size++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+		}
+	target[size++] = value;
+	return size;
+	}
+
+// returns false if the varint is truncated
+static bool varintRead(const uint8_t *source, uint32_t length, uint32_t &position, uint32_t &value) {
+	value = 0;
+	for (uint8_t shift = 0; shift < 35; shift += 7) {
+		if (position >= length) return false;
+		uint8_t data = source[position++];
+		value |= (uint32_t)(data & 0x7F) << shift;
+		if (!(data & 0x80)) return true;
+		}
+	return false;
 	}
 
-void oscMessage(const char pattern[], int32_t int32) {
-	memset(sendMessage.message, 0, sizeof(sendMessage.message));
-	sendMessage.size = 0;
-	int patternLength = strlen(pattern);
-	memcpy(sendMessage.message, pattern, patternLength);
-	int patternOffset = patternLength % 4;
-	int tagStart;
-	if (patternOffset == 0) tagStart = patternLength + 4;
-	else tagStart = patternLength + (4 - patternOffset);
-	memcpy(sendMessage.message + tagStart, ",i\0\0", 4);
-	int dataStart = tagStart + 4;
-	itoh(sendMessage.message, dataStart, int32);
-	sendMessage.size = dataStart + 4;
-	sendOSC();
+// small positive and negative differences are small unsigned values
+static inline uint32_t zigzag(int32_t value) {
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
 	}
 
-void oscMessage(const char pattern[]) {
-	memset(sendMessage.message, 0, sizeof(sendMessage.message));
-	sendMessage.size = 0;
-	int patternLength = strlen(pattern);
-	memcpy(sendMessage.message, pattern, patternLength);
-	int patternOffset = patternLength % 4;
-	int tagStart;
-	if (patternOffset == 0) tagStart = patternLength + 4;
-	else tagStart = patternLength + (4 - patternOffset);
-	memcpy(sendMessage.message + tagStart, ",\0\0\0", 4);
-	sendMessage.size = tagStart + 4;
-	sendOSC();
+static inline int32_t unzigzag(uint32_t value) {
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+	}
+
+enum {RECORDER_STOPPED, RECORDER_RECORDING, RECORDER_PLAYING};
+
+Recorder::Recorder(uint8_t *arena, uint32_t size) {
+	this->arena = arena;
+	capacity = size;
+	}
+
+Recorder::~Recorder() {
+	stop();
+	}
+
+void Recorder::attach(Gma3Context &context) {
+	stop();
+	this->context = &context;
+	}
+
+bool Recorder::record() {
+	if (context->recorder != nullptr && context->recorder != this) return false;
+	stop();
+	length = 0;
+	overflow = false;
+	recordDuration = 0;
+	rewind();
+	mode = RECORDER_RECORDING;
+	context->recorder = this;
+	return true;
+	}
+
+void Recorder::play(bool repeat) {
+	stop();
+	this->repeat = repeat;
+	rewind();
+	mode = RECORDER_PLAYING;
+	}
+
+void Recorder::stop() {
+	if (mode == RECORDER_RECORDING) {
+		recordDuration = millis() - startTime;
+		context->recorder = nullptr;
+		}
+	mode = RECORDER_STOPPED;
+	}
+
+void Recorder::rewind() {
+	position = 0;
+	startTime = millis();
+	eventTime = 0;
+	faderPrevious = 0;
+	valuePrevious = 0;
+	}
+
+void Recorder::update() {
+	if (mode != RECORDER_PLAYING) return;
+	uint32_t elapsed = millis() - startTime;
+	while (true) {
+		if (position >= length) {
+			if (!repeat || recordDuration == 0) {
+				mode = RECORDER_STOPPED;
+				return;
+				}
+			if (elapsed < recordDuration) return;
+			uint32_t late = elapsed - recordDuration; // the next pass keeps the timing of the first one
+			rewind();
+			startTime -= late;
+			elapsed = late;
+			continue;
+			}
+		uint32_t next = position;
+		uint32_t time, fader, value;
+		if (!varintRead(arena, length, next, time) || !varintRead(arena, length, next, fader) || !varintRead(arena, length, next, value)) {
+			mode = RECORDER_STOPPED; // corrupt recording
+			return;
+			}
+		if (elapsed < eventTime + time) return;
+		position = next;
+		eventTime += time;
+		faderPrevious += unzigzag(fader);
+		valuePrevious += unzigzag(value);
+		for (Fader *target = context->faderList; target != nullptr; target = target->faderNext) {
+			if (target->fader == faderPrevious) { // moves of faders which not exist on this surface are skipped
+				target->valueLast = valuePrevious;
+				target->sendPending = true;
+				if (context->rateCheck(ROUTE_FADER)) target->send(); // otherwise the fader sends the value later
+				break;
+				}
+			}
+		}
+	}
+
+void Recorder::add(uint16_t fader, int32_t value) {
+	uint32_t time = millis() - startTime;
+	uint8_t event[15];
+	uint8_t size = varintWrite(event, time - eventTime);
+	size += varintWrite(event + size, zigzag((int32_t)fader - faderPrevious));
+	size += varintWrite(event + size, zigzag(value - valuePrevious));
+	if (length + size > capacity) {
+		overflow = true;
+		stop();
+		return;
+		}
+	memcpy(arena + length, event, size);
+	length += size;
+	eventTime = time;
+	faderPrevious = fader;
+	valuePrevious = value;
+	}
+
+bool Recorder::recording() {
+	return mode == RECORDER_RECORDING;
+	}
+
+bool Recorder::playing() {
+	return mode == RECORDER_PLAYING;
+	}
+
+bool Recorder::full() {
+	return overflow;
+	}
+
+uint32_t Recorder::size() {
+	return length;
+	}
+
+uint32_t Recorder::duration() {
+	return mode == RECORDER_RECORDING ? millis() - startTime : recordDuration;
+	}
+
+size_t Recorder::save(Print &output) {
+	uint8_t header[sizeof(RECORDER_HEADER) + 8];
+	memcpy(header, RECORDER_HEADER, sizeof(RECORDER_HEADER) - 1);
+	header[sizeof(RECORDER_HEADER) - 1] = RECORDER_VERSION;
+	itoh(header, sizeof(RECORDER_HEADER), length);
+	itoh(header, sizeof(RECORDER_HEADER) + 4, duration());
+	size_t size = output.write(header, sizeof(header));
+	size += output.write(arena, length);
+	return size;
+	}
+
+bool Recorder::load(Stream &input) {
+	stop();
+	uint8_t header[sizeof(RECORDER_HEADER) + 8];
+	if (input.readBytes(header, sizeof(header)) != sizeof(header)) return false;
+	if (memcmp(header, RECORDER_HEADER, sizeof(RECORDER_HEADER) - 1) != 0 || header[sizeof(RECORDER_HEADER) - 1] != RECORDER_VERSION) return false;
+	uint32_t size = htoi(header, sizeof(RECORDER_HEADER));
+	if (size > capacity) return false;
+	length = 0; // an incomplete recording is not played
+	if (input.readBytes(arena, size) != size) return false;
+	length = size;
+	recordDuration = htoi(header, sizeof(RECORDER_HEADER) + 4);
+	overflow = false;
+	return true;
+	}
+
+int16_t IndicatorOutput::assign(uint16_t executor, uint16_t channel, indicator_t type, const char *key, uint8_t on, uint8_t off) {
+	if (mapCount == mapCapacity || channel >= channels) return -1;
+	struct IndicatorMap &map = maps[mapCount];
+	map.key = key;
+	map.executor = executor;
+	map.channel = channel;
+	map.type = type;
+	map.on = on;
+	map.off = off;
+	return mapCount++;
+	}
+
+void IndicatorOutput::assignClear() {
+	mapCount = 0;
+	}
+
+void IndicatorOutput::feed(Parser &parser) {
+	const char *pattern = parser.patternOSC();
+	if (*pattern < '0' || *pattern > '9') return; // only executor feedback, e.g. 13.13.1.5.201
+	const char *number = strrchr(pattern, '.');
+	int32_t executor = 0;
+	if (number == nullptr || dtoi(number + 1, executor) == 0) return;
+	for (uint16_t i = 0; i < mapCount; i++) {
+		const struct IndicatorMap &map = maps[i];
+		if (map.executor != executor) continue;
+		if (map.key != nullptr && strcmp(map.key, parser.stringOSC()) != 0) continue;
+		if (map.type == INDICATOR_LEVEL) {
+			float level = parser.floatOSC();
+			if (level < 0.0f) level = 0.0f;
+			if (level > 100.0f) level = 100.0f;
+			set(map.channel, map.off + (int16_t)((map.on - map.off) * level / 100.0f + (map.on >= map.off ? 0.5f : -0.5f)));
+			}
+		else set(map.channel, parser.int1OSC() != 0 ? map.on : map.off);
+		}
+	}
+
+void IndicatorOutput::set(uint16_t channel, uint8_t value) {
+	if (channel >= channels || values[channel] == value) return;
+	values[channel] = value;
+	dirty[channel >> 3] |= 1 << (channel & 7);
+	changed = true;
+	}
+
+uint8_t IndicatorOutput::get(uint16_t channel) {
+	if (channel >= channels) return 0;
+	return values[channel];
+	}
+
+void IndicatorOutput::frame(uint16_t interval) {
+	frameInterval = interval;
+	}
+
+void IndicatorOutput::refresh() {
+	memset(dirty, 0xFF, channels >> 3);
+	if (channels & 7) dirty[channels >> 3] = (1 << (channels & 7)) - 1;
+	changed = true;
+	}
+
+void IndicatorOutput::update() {
+	if (!changed || millis() - frameTime < frameInterval) return;
+	frameTime = millis();
+	changed = false;
+	// the dirty bits are collected to runs of channels, a run ends with the first unchanged channel
+	bool run = false;
+	uint16_t runStart = 0;
+	for (uint16_t i = 0; i < (channels + 7) >> 3; i++) {
+		uint8_t bits = dirty[i];
+		if (bits == 0xFF && run) { // the run continues, 8 channels at once
+			dirty[i] = 0;
+			continue;
+			}
+		if (bits == 0 && !run) continue;
+		dirty[i] = 0;
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			uint16_t channel = (i << 3) + bit;
+			if (bits & (1 << bit)) {
+				if (!run) runStart = channel;
+				run = true;
+				}
+			else if (run) {
+				sink->write(runStart, values + runStart, channel - runStart);
+				run = false;
+				}
+			}
+		}
+	if (run) sink->write(runStart, values + runStart, channels - runStart);
+	sink->show();
 	}
 
 float htof(uint8_t *msg, uint8_t dataStart) {
@@ -918,8 +2669,43 @@ void itoh(uint8_t *msg, uint8_t dataStart, int32_t value) {
 	msg[dataStart + 3] = int32Array[0];
 	}	
 
+uint8_t itod(char *buffer, int32_t number) {
+	char digits[10];
+	uint8_t count = 0;
+	uint32_t value = number < 0 ? 0 - (uint32_t)number : number;
+	if (value <= 0xFFFF) { // 16 bit division is much faster on 8 bit boards
+		uint16_t small = value;
+		do {
+			digits[count++] = '0' + small % 10;
+			small /= 10;
+			} while (small != 0);
+		}
+	else {
+		do {
+			digits[count++] = '0' + value % 10;
+			value /= 10;
+			} while (value != 0);
+		}
+	uint8_t length = 0;
+	if (number < 0) buffer[length++] = '-';
+	while (count > 0) buffer[length++] = digits[--count];
+	buffer[length] = 0;
+	return length;
+	}
+
+uint8_t dtoi(const char *string, int32_t &number) {
+	const char *start = string;
+	bool negative = false;
+	if (*string == '-' || *string == '+') negative = *string++ == '-';
+	if (*string < '0' || *string > '9') return 0;
+	uint32_t value = 0;
+	while (*string >= '0' && *string <= '9') value = value * 10 + (*string++ - '0');
+	number = negative ? 0 - value : value;
+	return string - start;
+	}
+
 const char* itoa(int32_t number) {
-	static char numstring[16];
-	sprintf(numstring, "%ld", number);
+	static char numstring[12];
+	itod(numstring, number);
 	return numstring;
 	}
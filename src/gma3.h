@@ -39,11 +39,167 @@ typedef void (*cbptr)();
 #define FADER_UPDATE_RATE_MS  40 // update rate, must low at possible for fetching
 #define FADER_THRESHOLD       2 // Jitter threshold of the faders
 
-// OSC settings
+// default names, can set as build flags, the names are stored in flash memory
+#ifndef GMA3_PREFIX_NAME
+#define GMA3_PREFIX_NAME        "gma3"
+#endif
+#ifndef GMA3_POOL_NAME
+#define GMA3_POOL_NAME          "DataPool"
+#endif
+#ifndef GMA3_PAGE_NAME
+#define GMA3_PAGE_NAME          "Page"
+#endif
+#ifndef GMA3_FADER_NAME
+#define GMA3_FADER_NAME         "Fader"
+#endif
+#ifndef GMA3_EXECUTOR_KNOB_NAME
+#define GMA3_EXECUTOR_KNOB_NAME "Encoder"
+#endif
+#ifndef GMA3_KEY_NAME
+#define GMA3_KEY_NAME           "Key"
+#endif
+
+// OSC settings, can set as build flags, Gma3Buffers allows other buffer sizes for a context
 #define NAME_LENGTH_MAX  32
+#ifndef OSC_PATTERN_SIZE
 #define OSC_PATTERN_SIZE 64
+#endif
+#ifndef OSC_STRING_SIZE
 #define OSC_STRING_SIZE  64
+#endif
+#ifndef OSC_MESSAGE_SIZE
 #define OSC_MESSAGE_SIZE 128
+#endif
+#ifndef OSC_SEND_SIZE
+#define OSC_SEND_SIZE    OSC_MESSAGE_SIZE // max. size of a sent message
+#endif
+#ifndef OSC_RECEIVE_SIZE
+#define OSC_RECEIVE_SIZE OSC_MESSAGE_SIZE // size of the receive buffer, larger messages are parsed from the stream
+#endif
+#ifndef OSC_BUNDLE_SIZE
+#if defined(__AVR__)
+#define OSC_BUNDLE_SIZE  0 // max. size of a bundle packet, larger bundles are split, 0 sends the messages one by one
+#else
+#define OSC_BUNDLE_SIZE  512
+#endif
+#endif
+
+// receive filter, the begin of a packet is checked before the packet is copied and parsed
+#ifndef OSC_PEEK_SIZE
+#define OSC_PEEK_SIZE 32 // bytes read for the prefix and filter check
+#endif
+#ifndef TCP_PARTIAL_TIMEOUT
+#define TCP_PARTIAL_TIMEOUT 500 // ms, a TCP message is dropped if its rest doesn't arrive, the UDP interface waits meanwhile
+#endif
+#if defined(__AVR__)
+#define FILTER_RULES 2 // max. number of address filters of a Parser
+#else
+#define FILTER_RULES 4
+#endif
+#define FILTER_ADDRESS_SIZE 16
+
+// latency tracing, 1 enables the input to wire latency histograms, can set as build flag
+#ifndef GMA3_LATENCY
+#define GMA3_LATENCY 0
+#endif
+#define LATENCY_BUCKETS 16
+
+// loop time profiler, 1 enables the profiler, can set as build flag
+#ifndef GMA3_PROFILE
+#define GMA3_PROFILE 0
+#endif
+#define PROFILE_CONTROLS_MAX 16 // max. number of registered controls
+
+// command merging, 1 enables commandMerge() and the pending command line of OSC_STRING_SIZE per context, can set as build flag
+#ifndef GMA3_MERGE
+#define GMA3_MERGE 0
+#endif
+
+// rate limit, 1 enables rateLimit() and the token buckets of the message types per context, can set as build flag
+#ifndef GMA3_RATE_LIMIT
+#define GMA3_RATE_LIMIT 0
+#endif
+
+// macro sequences, 1 enables macro() and the MACRO_SLOTS sequences per context, can set as build flag
+#ifndef GMA3_MACROS
+#define GMA3_MACROS 0
+#endif
+
+// statistics, 1 enables the packet and error counters, the loop times and their publishing per context, can set as build flag
+#ifndef GMA3_STATISTICS
+#if defined(__AVR__)
+#define GMA3_STATISTICS 0 // about 100 bytes per context
+#else
+#define GMA3_STATISTICS 1
+#endif
+#endif
+
+// threaded mode, 1 enables the packet queue between an input task and a network task, can set as build flag
+// needs std::atomic, e.g. ESP32, RP2040 or the host build
+#ifndef GMA3_THREADED
+#define GMA3_THREADED 0
+#endif
+#ifndef OSC_QUEUE_SIZE
+#define OSC_QUEUE_SIZE 1024 // size of the packet queue of a context, max. 32768
+#endif
+#if GMA3_THREADED
+#include <atomic>
+typedef std::atomic<uint16_t> common_t; // common page and pool number, shared by the tasks
+typedef std::atomic<uint32_t> activity_t; // idle state, written by the input task and by the Parser on the network task
+typedef std::atomic<bool> flag_t;
+typedef std::atomic<const char*> nameptr_t; // names, read with the seqlock
+typedef std::atomic<uint8_t> namebyte_t;
+static_assert(OSC_QUEUE_SIZE <= 32768, "OSC_QUEUE_SIZE must not exceed 32768");
+#else
+typedef uint16_t common_t;
+typedef uint32_t activity_t;
+typedef bool flag_t;
+typedef const char *nameptr_t;
+typedef uint8_t namebyte_t;
+#endif
+
+// the GMA3_ feature flags change the layout of Gma3Context, they must be global build flags for the library and the sketch,
+// a sketch compiled with other flags than the library fails to link with an undefined gma3Features_... symbol
+#define GMA3_FEATURES_NAME(l, p, m, r, x, s, t) gma3Features_L##l##_P##p##_M##m##_R##r##_X##x##_S##s##_T##t
+#define GMA3_FEATURES_EXPAND(l, p, m, r, x, s, t) GMA3_FEATURES_NAME(l, p, m, r, x, s, t)
+#define GMA3_FEATURES GMA3_FEATURES_EXPAND(GMA3_LATENCY, GMA3_PROFILE, GMA3_MERGE, GMA3_RATE_LIMIT, GMA3_MACROS, GMA3_STATISTICS, GMA3_THREADED)
+extern const uint8_t GMA3_FEATURES;
+static const uint8_t *const gma3FeaturesCheck PROGMEM __attribute__((used)) = &GMA3_FEATURES;
+
+// traffic capture, frame: time in us (4 bytes), flags (1 byte), size (2 bytes), packet, all big endian
+#define CAPTURE_HEADER   "gma3cap" // file header including the version byte 1
+#define CAPTURE_VERSION  1
+#define CAPTURE_RECEIVED 0x01 // flag for received packets, otherwise sent
+#define CAPTURE_TCP      0x02 // flag for TCP packets, otherwise UDP
+
+// OSC timetags, NTP format: seconds since 1900 (upper 32 bits) and fraction of a second (lower 32 bits)
+#define TIMETAG_IMMEDIATE 1ULL // execute the bundle on arrival
+#define TIMETAG_UNIX_OFFSET 2208988800UL // seconds from 1900 to 1970
+
+// macro sequences, steps are separated by a new line, a step #<ms> waits, e.g. "Go+ Executor 201\n#500\nGo+ Executor 202"
+#define MACRO_SLOTS     4 // max. number of running sequences per context
+#define MACRO_SEPARATOR '\n'
+#define MACRO_WAIT      '#'
+
+// fader motion recording, file: header including the version byte 1, size (4 bytes), duration in ms (4 bytes), events, all big endian
+// event: time since the previous event in ms, fader number and value as differences to the previous event, all as varints
+#define RECORDER_HEADER  "gma3rec"
+#define RECORDER_VERSION 1
+
+// surface snapshot, header including the version byte 1, payload size (2 bytes), CRC-16/CCITT of the payload (2 bytes), payload, all big endian
+// payload: common page, common pool, faders, keys and executorKnobs, every control list starts with the count
+// fader: number, local page, local pool, fetch value (2 bytes each), flags (1 byte), value (2 bytes), key and executorKnob: number, local page, local pool
+#define SNAPSHOT_HEADER      "gma3snp"
+#define SNAPSHOT_VERSION     1
+#define SNAPSHOT_HEADER_SIZE 12
+#define SNAPSHOT_LOCKED      0x01 // fader flag, waits for the fetch value
+#define SNAPSHOT_VALUE       0x02 // fader flag, the value was read
+
+// indicator output, changed channels are sent to the sink once per frame
+#define INDICATOR_FRAME_MS 20
+
+// network settings
+#define DESTINATIONS_MAX 4 // max. number of consoles and receivers
 
 // defines for TCPSLIP
 #define END     0xC0 // indicates end of packet
@@ -60,6 +216,59 @@ typedef enum ProtocolType {
 	TCP,
 	} protocol_t;
 
+/**
+ * @brief Role of a destination
+ * 
+ */
+typedef enum DestinationRole {
+	PRIMARY,
+	BACKUP,
+	} role_t;
+
+/**
+ * @brief Message types for routing to UDP or TCP
+ * 
+ */
+typedef enum RouteType {
+	ROUTE_KEY,
+	ROUTE_FADER,
+	ROUTE_EXECUTOR_KNOB,
+	ROUTE_COMMAND, // commands, CmdButton, Pages and Pools
+	ROUTE_OSC, // oscMessage() send by the user
+	ROUTE_TYPES
+	} route_t;
+
+/**
+ * @brief Subsystems of the profiler, the times include the nested subsystems,
+ * e.g. PROFILE_KEY includes PROFILE_SEND
+ * 
+ */
+typedef enum ProfileType {
+	PROFILE_PARSER, // Parser::update()
+	PROFILE_SEND, // sending packets to all destinations
+	PROFILE_KEY,
+	PROFILE_FADER,
+	PROFILE_ANALOG, // analogRead() of the faders
+	PROFILE_EXECUTOR_KNOB,
+	PROFILE_CMD_BUTTON,
+	PROFILE_PAGES_POOLS,
+	PROFILE_SUBSYSTEMS
+	} profile_t;
+
+/**
+ * @brief Names used for the OSC patterns
+ * 
+ */
+typedef enum NameType {
+	NAME_PREFIX,
+	NAME_POOL,
+	NAME_PAGE,
+	NAME_FADER,
+	NAME_EXECUTOR_KNOB,
+	NAME_KEY,
+	NAME_TYPES
+	} name_t;
+
 /**
  * @brief OSC data types
  * 
@@ -77,12 +286,96 @@ typedef enum SendMode {
 	LOCAL,
 	} send_t;
 
+/**
+ * @brief Feedback shown by an indicator channel
+ * 
+ */
+typedef enum IndicatorType {
+	INDICATOR_STATE, // integer argument, on or off
+	INDICATOR_LEVEL, // float argument 0...100, scaled between off and on
+	} indicator_t;
+
 struct Message {
-	uint8_t message[OSC_MESSAGE_SIZE];
+	uint8_t *message; // buffer of the context
+	uint16_t capacity;
 	int32_t size;
 	protocol_t protocol;
 	};
 
+struct Destination {
+	uint32_t ip; // IPAddress as raw value, keeps the context constant initialized
+	uint16_t port;
+	protocol_t protocol;
+	UDP *udp;
+	Client *tcp;
+	role_t role;
+	bool enabled;
+	uint32_t seen; // last message received
+	};
+
+struct Statistics {
+	uint32_t packetsSent;
+	uint32_t bytesSent;
+	uint32_t packetsReceived;
+	uint32_t bytesReceived;
+	uint32_t sendFailures; // beginPacket(), write() or endPacket() failed
+	uint32_t oversizedReceives; // received packets larger than the receive buffer, parsed from the stream
+	uint32_t oversizedSends; // messages larger than the send buffer
+	uint32_t parseErrors; // received messages which are malformed or incomplete
+	uint32_t prefixRejects; // received packets with another prefix
+	uint32_t filterRejects; // received packets which match no address filter of the Parser
+	uint32_t tcpReconnects;
+	uint32_t queueDrops; // packets dropped because the queue of the threaded mode was full
+	uint32_t loopTimeMax; // us, measured by update()
+	uint32_t loopTimeAverage; // us
+	};
+
+struct Latency {
+	uint32_t buckets[LATENCY_BUCKETS]; // bucket n counts latencies from 2^n to 2^(n+1) - 1 us, bucket 0 includes 0us
+	uint32_t count;
+	uint32_t max; // us
+	};
+
+struct RateLimit {
+	uint16_t rate; // messages per second, 0 disables the limit
+	uint16_t burst; // max. messages at once
+	int32_t tokens; // 1/1000 message, negative after messages with priority
+	uint32_t time; // ms, last refill
+	uint32_t throttled; // checks of faders and encoders which had to wait
+	};
+
+struct Profile {
+	const char *name; // name of a registered control, nullptr for subsystems
+	const void *control;
+	uint32_t calls;
+	uint32_t max; // ticks
+	uint64_t total; // ticks
+	};
+
+struct Macro {
+	const char *steps; // RAM or flash memory, nullptr if the slot is free
+	const void *owner; // a CmdButton restarts its own sequence
+	uint16_t position; // next step
+	uint32_t due; // ms, time of the next step
+	bool flash;
+	};
+
+struct Filter {
+	char address[FILTER_ADDRESS_SIZE]; // begin of the address after the prefix
+	uint8_t length;
+	int32_t first; // range of the number which follows the address, no range if first > last
+	int32_t last;
+	};
+
+struct IndicatorMap {
+	const char *key; // string argument of the feedback, e.g. "Go+", nullptr for all, not copied
+	uint16_t executor;
+	uint16_t channel;
+	indicator_t type;
+	uint8_t on;
+	uint8_t off;
+	};
+
 struct Data {
 	char pattern[OSC_PATTERN_SIZE];
 	char tag[12];
@@ -91,12 +384,537 @@ struct Data {
 	float float32;
 	};
 
+class Key;
+class Fader;
+class ExecutorKnob;
+class Recorder;
+
+/**
+ * @brief Non-volatile memory for the snapshots, implemented by the sketch,
+ * e.g. with EEPROM, a file in flash memory or FileStorage on the host
+ * 
+ */
+class SnapshotStorage {
+	public:
+		virtual bool read(uint32_t address, uint8_t *data, uint16_t size) = 0;
+		virtual bool write(uint32_t address, const uint8_t *data, uint16_t size) = 0;
+		virtual bool commit() {return true;} // e.g. EEPROM.commit() on ESP boards
+	};
+
+extern const char nameDefaultPrefix[] PROGMEM;
+extern const char nameDefaultPool[] PROGMEM;
+extern const char nameDefaultPage[] PROGMEM;
+extern const char nameDefaultFader[] PROGMEM;
+extern const char nameDefaultExecutorKnob[] PROGMEM;
+extern const char nameDefaultKey[] PROGMEM;
+
+/**
+ * @brief Context object which holds the names, page and pool numbers, interfaces and buffers
+ * - the global functions use the default context gma3
+ * - objects use the default context, attach() connects them to another context
+ * - several contexts allows independent surface sections, e.g. two users on different pages
+ * - the buffers are owned by Gma3Buffers, Gma3 is a context with the default buffer sizes
+ */
+class Gma3Context {
+	public:
+
+		/**
+		 * @brief Set the names, refer to the global functions,
+		 * the names are not copied and must exist as long as the context
+		 * 
+		 * @param name string or F() string in flash memory
+		 */
+		void prefixName(const char *prefix);
+		void prefixName(const __FlashStringHelper *prefix);
+		void dataPoolName(const char *pool);
+		void dataPoolName(const __FlashStringHelper *pool);
+		void pageName(const char *page);
+		void pageName(const __FlashStringHelper *page);
+		void faderName(const char *fader);
+		void faderName(const __FlashStringHelper *fader);
+		void executorKnobName(const char *executorKnob);
+		void executorKnobName(const __FlashStringHelper *executorKnob);
+		void keyName(const char *key);
+		void keyName(const __FlashStringHelper *key);
+
+		/**
+		 * @brief Set the interfaces and destinations, refer to the global functions
+		 * 
+		 */
+		void interface(UDP &udp, IPAddress ip, uint16_t port = 8000);
+		void interface(Client &tcp, protocol_t protocol, IPAddress ip, uint16_t port = 9000);
+		int8_t destination(UDP &udp, IPAddress ip, uint16_t port = 8000, role_t role = PRIMARY);
+		int8_t destination(Client &tcp, IPAddress ip, uint16_t port = 9000, role_t role = PRIMARY);
+		void destinationEnable(uint8_t index, bool state);
+		bool destinationHealth(uint8_t index);
+		void failover(uint32_t timeout);
+		void route(route_t type, protocol_t protocol);
+		protocol_t route(route_t type);
+
+		/**
+		 * @brief Send messages, refer to the global functions
+		 * 
+		 */
+		void sendOSC();
+		void command(const char cmd[]);
+		void bundleBegin(uint64_t timetag = TIMETAG_IMMEDIATE);
+		void bundleEnd();
+		void oscMessage(const char pattern[], int32_t int32);
+		void oscMessage(const char pattern[], float float32);
+		void oscMessage(const char pattern[], const char string[]);
+		void oscMessage(const char pattern[]);
+
+		/**
+		 * @brief Get and set the common page and pool numbers, refer to the global functions
+		 * 
+		 */
+		uint16_t commonPool();
+		void commonPool(uint16_t pool);
+		uint16_t commonPage();
+		void commonPage(uint16_t page);
+
+		/**
+		 * @brief Measure the loop time and publish the statistics, must be in loop()
+		 * 
+		 */
+		void update();
+
+#if GMA3_STATISTICS
+		/**
+		 * @brief Get, reset and publish the statistics, refer to the global functions
+		 * 
+		 */
+		const struct Statistics& statistics();
+		void statisticsReset();
+		void statisticsPublish(const char *address, uint32_t interval = 1000);
+#endif
+
+#if GMA3_LATENCY
+		/**
+		 * @brief Get the latency histogram from an input event to the sent message
+		 * 
+		 * @param type ROUTE_KEY, ROUTE_FADER, ROUTE_EXECUTOR_KNOB or ROUTE_COMMAND for CmdButton
+		 * @return const struct Latency& histogram with log2 buckets in us
+		 */
+		const struct Latency& latency(route_t type);
+
+		/**
+		 * @brief Reset all latency histograms
+		 * 
+		 */
+		void latencyReset();
+
+		/**
+		 * @brief Print the latency histograms for the latency report tool,
+		 * one line per type: latency <type> <max> <bucket 0> ... <bucket 15>
+		 * 
+		 * @param output e.g. Serial
+		 */
+		void latencyPrint(Print &output);
+#endif
+
+#if GMA3_PROFILE
+		/**
+		 * @brief Start or stop the profiler, the overhead of a stopped profiler is a flag check per update
+		 * 
+		 * @param state true to start, false to stop
+		 */
+		void profile(bool state);
+
+		/**
+		 * @brief Reset all profiler times
+		 * 
+		 */
+		void profileReset();
+
+		/**
+		 * @brief Register a control for a separate time in the profile, e.g. &fader201
+		 * 
+		 * @param control pointer to a Key, Fader, ExecutorKnob, CmdButton, Pages, Pools or Parser object
+		 * @param name name in the profile, must be constant
+		 * @return true if registered, false if there are already PROFILE_CONTROLS_MAX controls
+		 */
+		bool profileControl(const void *control, const char *name);
+
+		/**
+		 * @brief Print the profile ranked by the total time:
+		 * rank, name, calls, total us, average us, max us and the share of the time since reset in percent
+		 * 
+		 * @param output e.g. Serial
+		 */
+		void profilePrint(Print &output);
+
+		/**
+		 * @brief Send the total times in us ranked as OSC bundle to /prefix/address/name
+		 * 
+		 * @param address OSC address without prefix, e.g. "profile"
+		 */
+		void profileSend(const char *address);
+#endif
+
+		/**
+		 * @brief Capture all sent and received packets as binary log with timestamps,
+		 * e.g. to Serial or a file on the host, for the replay tool
+		 * 
+		 * @param output stream for the log, the header is written immediately
+		 */
+		void capture(Print &output);
+
+		/**
+		 * @brief Stop the capture
+		 * 
+		 */
+		void captureStop();
+
+		/**
+		 * @brief Get the size of a snapshot of the context, e.g. for the addresses of several snapshots
+		 * 
+		 * @return uint16_t bytes including the header
+		 */
+		uint16_t snapshotSize();
+
+		/**
+		 * @brief Save the common page and pool and the local page and pool of all keys, faders and executorKnobs,
+		 * the fetch value, lock state and last value of the faders, the header is written last
+		 * 
+		 * @param storage non-volatile memory
+		 * @param address start address of the snapshot in the storage
+		 * @return true saved
+		 * @return false write failed
+		 */
+		bool snapshotSave(SnapshotStorage &storage, uint32_t address = 0);
+
+		/**
+		 * @brief Restore a snapshot and send the values of the unlocked faders as one bundle,
+		 * the controls are matched by the order of construction and their numbers
+		 * 
+		 * @param storage non-volatile memory
+		 * @param address start address of the snapshot in the storage
+		 * @return true recalled
+		 * @return false no snapshot, wrong version or CRC, nothing is changed
+		 */
+		bool snapshotRecall(SnapshotStorage &storage, uint32_t address = 0);
+
+#if GMA3_THREADED
+		/**
+		 * @brief Queue the sent packets for a network task instead of sending them immediately,
+		 * one task updates the controls, another task calls transmit() and Parser::update(),
+		 * must be set before the tasks are started
+		 * 
+		 * @param state true to queue the packets, false to send them immediately
+		 */
+		void threaded(bool state);
+
+		/**
+		 * @brief Send all queued packets, this must happen in the network task
+		 * 
+		 */
+		void transmit();
+#endif
+
+		/**
+		 * @brief Send the values of all unlocked faders of this context which use the common page or pool
+		 * 
+		 * @param page true for a page change, false for a pool change
+		 */
+		void resync(bool page = true);
+
+		/**
+		 * @brief Set the OSC time of now, for scheduled timetags derived from millis(),
+		 * e.g. from a NTP client, the clock of the console must be synchronized to the same source
+		 * 
+		 * @param timetag OSC time in NTP format
+		 */
+		void clockOffset(uint64_t timetag);
+
+		/**
+		 * @brief Set the OSC time of now from a unix time, e.g. NTPClient::getEpochTime()
+		 * 
+		 * @param seconds since 1970
+		 * @param milliseconds fraction of the second
+		 */
+		void clockOffsetUnix(uint32_t seconds, uint16_t milliseconds = 0);
+
+		/**
+		 * @brief Convert a millis() time to an OSC timetag, e.g. timetag(millis() + 20) for bundleBegin()
+		 * 
+		 * @param time in ms, can be in the past
+		 * @return uint64_t timetag, TIMETAG_IMMEDIATE if the clock offset is not set
+		 */
+		uint64_t timetag(uint32_t time);
+
+#if GMA3_MACROS
+		/**
+		 * @brief Start a sequence of commands and waits, it runs in the background by update(),
+		 * steps are separated by a new line, a step #<ms> waits, e.g. F("Go+ Executor 201\n#500\nGo+ Executor 202")
+		 * 
+		 * @param steps string or F() string in flash memory, the string is not copied and must exist until the sequence ends
+		 * @return true if started, false if all MACRO_SLOTS are running
+		 */
+		bool macro(const char *steps);
+		bool macro(const __FlashStringHelper *steps);
+
+		/**
+		 * @brief Stop all running sequences
+		 * 
+		 */
+		void macroStop();
+#endif
+
+#if GMA3_MERGE
+		/**
+		 * @brief Merge the commands of a loop into one command line "cmd1; cmd2", up to OSC_STRING_SIZE,
+		 * the merged commands are sent by update(), before any other message and at bundleEnd(), so the order is kept
+		 * 
+		 * @param state true to merge, false to send every command immediately
+		 */
+		void commandMerge(bool state);
+#endif
+
+#if GMA3_RATE_LIMIT
+		/**
+		 * @brief Limit the sent messages with a token bucket in front of sendOSC(), globally or for a message type,
+		 * faders and encoders are deferred and send their latest value when a token is available,
+		 * keys and commands have priority and are never dropped, they can overdraw the bucket
+		 * 
+		 * @param type ROUTE_KEY, ROUTE_FADER, ROUTE_EXECUTOR_KNOB, ROUTE_COMMAND or ROUTE_OSC, without type for the global limit
+		 * @param rate messages per second, 0 disables the limit
+		 * @param burst max. messages at once, 0 for rate / 10 + 1, at least one message
+		 */
+		void rateLimit(uint16_t rate, uint16_t burst = 0);
+		void rateLimit(route_t type, uint16_t rate, uint16_t burst = 0);
+
+		/**
+		 * @brief Get the token bucket state, globally or for a message type
+		 * 
+		 * @return const struct RateLimit& rate, burst, tokens in 1/1000 messages and the throttle count
+		 */
+		const struct RateLimit& rateState();
+		const struct RateLimit& rateState(route_t type);
+#endif
+
+		/**
+		 * @brief Drop to a lower scan rate after a quiet period, between the idle scans
+		 * the pin and analog reads of the controls and the Parser are skipped
+		 * 
+		 * @param timeout ms without sent or received packets, 0 disables the idle mode
+		 * @param interval ms between the scans in idle mode
+		 * in threaded mode it must be set before the tasks are started
+		 */
+		void idle(uint32_t timeout, uint32_t interval = 50);
+
+		/**
+		 * @brief Leave the idle mode immediately, the next loop scans all controls,
+		 * can called from an interrupt, e.g. pin change, ADC window comparator or the interrupt pin of the Ethernet controller
+		 * 
+		 */
+		void wake();
+
+		/**
+		 * @brief Check if the controls are scanned in this loop, e.g. for inputs on I/O expanders
+		 * 
+		 * @return true if active or an idle scan is due, false while idle between two scans
+		 */
+		bool scanning() {
+			return idleScan || idleWoken();
+			}
+
+	protected:
+		constexpr Gma3Context(uint8_t *send, uint16_t sendCapacity, uint8_t *receive, uint16_t receiveCapacity, uint8_t *bundle, uint16_t bundleCapacity)
+			: receiveMessage{receive, receiveCapacity, 0, UDPOSC}, sendMessage{send, sendCapacity, 0, UDPOSC}, bundleMessage(bundle), bundleCapacity(bundleCapacity) {}
+
+	private:
+		friend class Parser;
+		friend class Pools;
+		friend class Pages;
+		friend class Key;
+		friend class Fader;
+		friend class ExecutorKnob;
+		friend class CmdButton;
+		friend class Recorder;
+		friend class ProfileScope;
+		void name(name_t type, const char *name, bool flash);
+		uint8_t nameCopy(char *target, name_t type);
+		uint8_t patternPrefix(char *pattern);
+		uint8_t patternExecutor(char *pattern, name_t type, uint16_t pool, uint16_t page, uint16_t number);
+		bool prefixCheck(const char *pattern, int32_t length);
+		uint8_t prefixOffset();
+		int8_t destinationAdd(UDP *udp, Client *tcp, protocol_t protocol, IPAddress ip, uint16_t port, role_t role);
+		bool destinationCheck(struct Destination &destination);
+		protocol_t routeProtocol(protocol_t protocol);
+		void routeMessage(route_t type);
+		bool sendFits(int32_t size);
+		void sendPacket(const uint8_t *packet, int32_t size, protocol_t protocol);
+		void transmitPacket(const uint8_t *packet, int32_t size, protocol_t protocol);
+		void bundleElement(protocol_t protocol);
+		void sendAddress(const char address[], int32_t value);
+#if GMA3_STATISTICS
+		void statisticsSend();
+#endif
+		void captureFrame(uint8_t flags, const uint8_t *packet, int32_t size);
+		bool snapshotPayload(SnapshotStorage &storage, uint32_t address, uint16_t size, bool restore, uint16_t &crc);
+#if GMA3_THREADED
+		bool queuePush(const uint8_t *packet, int32_t size, protocol_t protocol);
+		// seqlock for the names, a reader repeats when a name was changed meanwhile
+		void namesWriteBegin() {
+			namesSequence.store(namesSequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			}
+		void namesWriteEnd() {
+			namesSequence.store(namesSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+		uint16_t namesReadBegin() {
+			uint16_t sequence;
+			while ((sequence = namesSequence.load(std::memory_order_acquire)) & 1) {}
+			return sequence;
+			}
+		bool namesReadRetry(uint16_t sequence) {
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return namesSequence.load(std::memory_order_relaxed) != sequence;
+			}
+#else
+		void namesWriteBegin() {}
+		void namesWriteEnd() {}
+		uint16_t namesReadBegin() {return 0;}
+		bool namesReadRetry(uint16_t sequence) {(void)sequence; return false;}
+#endif
+		void activity();
+#if GMA3_THREADED
+		bool idleWoken() {return idleWake.load(std::memory_order_relaxed);}
+		void idleWoken(bool state) {idleWake.store(state, std::memory_order_relaxed);}
+#else
+		// accessed as volatile, wake() can called from an interrupt, a volatile member would prevent the constant initialization
+		bool idleWoken() {return *(volatile bool*)&idleWake;}
+		void idleWoken(bool state) {*(volatile bool*)&idleWake = state;}
+#endif
+#if GMA3_MERGE
+		void commandFlush();
+		void mergeFlush() {if (commandLength > 0) commandFlush();}
+#else
+		void mergeFlush() {}
+#endif
+#if GMA3_RATE_LIMIT
+		bool rateCheck(route_t type);
+		void rateRefill(struct RateLimit &limit, uint32_t time);
+#else
+		bool rateCheck(route_t type) {(void)type; return true;}
+#endif
+#if GMA3_MACROS
+		bool macroStart(const char *steps, bool flash, const void *owner);
+		void macroRun();
+#endif
+#if GMA3_LATENCY
+		void latencyBegin(route_t type);
+		void latencyEnd();
+#endif
+		// all members are initialized, so the default context is ready before objects are constructed
+		struct Message receiveMessage;
+		struct Message sendMessage;
+		struct Destination destinations[DESTINATIONS_MAX] = {};
+		uint8_t destinationCount = 0;
+		uint32_t failoverTimeout = 0; // 0 disables the UDP receive timeout
+		protocol_t routing[ROUTE_TYPES] = {UDPOSC, UDPOSC, UDPOSC, UDPOSC, UDPOSC}; // unconfigured interfaces fall back to the other one
+		bool bundleActive = false;
+		uint8_t *bundleMessage; // the bundle is encoded once and send to all destinations
+		uint16_t bundleCapacity; // 0 disables bundles, the messages are send one by one
+		int32_t bundleSize = 0; // 0 if no bundle is open
+		protocol_t bundleProtocol = UDPOSC;
+		uint64_t bundleTimetag = TIMETAG_IMMEDIATE; // all packets of a split bundle have the same timetag
+		uint64_t clockTimetag = 0; // OSC time at clockTime, 0 if not set
+		uint32_t clockTime = 0; // ms
+#if GMA3_MACROS
+		struct Macro macros[MACRO_SLOTS] = {};
+#endif
+#if GMA3_MERGE
+		bool commandMerging = false;
+		uint16_t commandLength = 0; // 0 if no command is pending, OSC_STRING_SIZE can exceed 255
+		char commandPending[OSC_STRING_SIZE] = "";
+#endif
+		route_t sendRoute = ROUTE_OSC; // type of the message in progress
+#if GMA3_RATE_LIMIT
+		bool rateActive = false; // a limit is set
+		struct RateLimit rateLimits[ROUTE_TYPES + 1] = {}; // message types, global limit last
+#endif
+		common_t pageCommon{1};
+		common_t poolCommon{1};
+		nameptr_t names[NAME_TYPES] = {{nameDefaultPrefix}, {nameDefaultPool}, {nameDefaultPage}, {nameDefaultFader}, {nameDefaultExecutorKnob}, {nameDefaultKey}};
+		namebyte_t namesFlash{(1 << NAME_TYPES) - 1}; // bit per name in flash memory
+		namebyte_t prefixLength{sizeof(GMA3_PREFIX_NAME) - 1};
+		Key *keyList = nullptr;
+		Fader *faderList = nullptr;
+		ExecutorKnob *executorKnobList = nullptr;
+		Recorder *recorder = nullptr; // nullptr if no fader motion is recorded
+#if GMA3_STATISTICS
+		struct Statistics stats = {};
+		char statsAddress[NAME_LENGTH_MAX] = "";
+		uint32_t statsInterval = 0; // 0 disables publishing
+		uint32_t statsTime = 0;
+		uint32_t loopLast = 0;
+		bool idleMuted = false; // packets sent meanwhile are no activity, e.g. the statistics
+#endif
+		Print *captureOutput = nullptr; // nullptr if the capture is stopped
+		uint32_t idleTimeout = 0; // ms, 0 disables the idle mode
+		uint32_t idleInterval = 50; // ms
+		uint32_t idleTime = 0; // last idle scan
+		activity_t activityTime{0}; // last sent or received packet
+		flag_t idleScan{true}; // scan the controls in this loop
+		flag_t idleWake{false}; // set by wake()
+#if GMA3_THREADED
+		bool queueActive = false;
+		uint8_t queue[OSC_QUEUE_SIZE] = {}; // entries: size (2 bytes), protocol (1 byte), packet
+		std::atomic<uint16_t> queueHead{0}; // written by the input task
+		std::atomic<uint16_t> queueTail{0}; // written by the network task
+		std::atomic<uint16_t> namesSequence{0}; // odd while a name is changed
+#endif
+#if GMA3_PROFILE
+		struct Profile profileEntries[PROFILE_SUBSYSTEMS + PROFILE_CONTROLS_MAX] = {}; // subsystems first
+		uint8_t profileControls = 0;
+		bool profileActive = false;
+		uint32_t profileTime = 0; // ms, start of the measurement
+#endif
+#if GMA3_LATENCY
+		struct Latency latencyHistograms[ROUTE_TYPES] = {};
+		uint32_t latencyTime = 0;
+		route_t latencyType = ROUTE_OSC; // type of the input event
+		bool latencyPending = false;
+#endif
+	};
+
+/**
+ * @brief Context with its own buffers, the sizes are choosen by the sketch, e.g.
+ * Gma3Buffers<48, 64, 0> for numeric messages, small feedback and without bundles or
+ * Gma3Buffers<128, 256, 1400> for bundles up to the Ethernet MTU
+ * 
+ * @tparam SEND_SIZE max. size of a sent message, larger messages are dropped
+ * @tparam RECEIVE_SIZE size of the receive buffer, larger packets are parsed from the stream
+ * @tparam BUNDLE_SIZE max. size of a bundle packet, 0 sends the messages of a bundle one by one
+ */
+template <uint16_t SEND_SIZE, uint16_t RECEIVE_SIZE, uint16_t BUNDLE_SIZE = OSC_BUNDLE_SIZE>
+class Gma3Buffers : public Gma3Context {
+	public:
+		constexpr Gma3Buffers() : Gma3Context(sendBuffer, SEND_SIZE, receiveBuffer, RECEIVE_SIZE, bundleBuffer, BUNDLE_SIZE) {}
+
+	private:
+		uint8_t sendBuffer[SEND_SIZE] = {};
+		uint8_t receiveBuffer[RECEIVE_SIZE] = {};
+		uint8_t bundleBuffer[BUNDLE_SIZE > 0 ? BUNDLE_SIZE : 1] = {};
+	};
+
+/**
+ * @brief Context with the default buffer sizes
+ * 
+ */
+typedef Gma3Buffers<OSC_SEND_SIZE, OSC_RECEIVE_SIZE, OSC_BUNDLE_SIZE> Gma3;
+
+extern Gma3 gma3;
+
 /**
  * @brief set the Prefix name
  * 
- * @param prefix 
+ * @param prefix string or F() string in flash memory, not copied
  */
 void prefixName(const char *prefix);
+void prefixName(const __FlashStringHelper *prefix);
 
 /**
  * @brief set the DataPool name
@@ -104,6 +922,7 @@ void prefixName(const char *prefix);
  * @param pool 
  */
 void dataPoolName(const char *pool);
+void dataPoolName(const __FlashStringHelper *pool);
 
 /**
  * @brief set the Page name
@@ -111,6 +930,7 @@ void dataPoolName(const char *pool);
  * @param page 
  */
 void pageName(const char *page);
+void pageName(const __FlashStringHelper *page);
 
 /**
  * @brief set the Fader name
@@ -118,6 +938,7 @@ void pageName(const char *page);
  * @param fader 
  */
 void faderName(const char *fader);
+void faderName(const __FlashStringHelper *fader);
 
 /**
  * @brief set the ExecutorKnob name
@@ -125,6 +946,7 @@ void faderName(const char *fader);
  * @param executorKnob 
  */
 void executorKnobName(const char *executorKnob);
+void executorKnobName(const __FlashStringHelper *executorKnob);
 
 /**
  * @brief set the Key name
@@ -132,6 +954,7 @@ void executorKnobName(const char *executorKnob);
  * @param key 
  */
 void keyName(const char *key);
+void keyName(const __FlashStringHelper *key);
 
 /**
  * @brief Set UDP interface
@@ -152,6 +975,70 @@ void interface(UDP &udp, IPAddress ip, uint16_t port = 8000);
  */
 void interface(Client &tcp, protocol_t protocol, IPAddress ip, uint16_t port = 9000);
 
+/**
+ * @brief Add a further UDP destination, e.g. a backup console or onPC for recording,
+ * the UDP socket must started with interface() or begin()
+ * 
+ * @param udp UDP interface
+ * @param ip IP address of the destination
+ * @param port UDP port of the destination, standard port is 8000
+ * @param role PRIMARY always receives all messages, BACKUP only if no PRIMARY of the same protocol is available
+ * @return int8_t index of the destination, -1 if there are already DESTINATIONS_MAX destinations
+ */
+int8_t destination(UDP &udp, IPAddress ip, uint16_t port = 8000, role_t role = PRIMARY);
+
+/**
+ * @brief Add a further TCP destination, every destination needs its own TCP socket
+ * 
+ * @param tcp TCP interface
+ * @param ip IP address of the destination
+ * @param port TCP port of the destination, standard port is 9000
+ * @param role PRIMARY always receives all messages, BACKUP only if no PRIMARY of the same protocol is available
+ * @return int8_t index of the destination, -1 if there are already DESTINATIONS_MAX destinations
+ */
+int8_t destination(Client &tcp, IPAddress ip, uint16_t port = 9000, role_t role = PRIMARY);
+
+/**
+ * @brief Enable or disable a destination
+ * 
+ * @param index index of the destination, interfaces are also destinations in order of configuration
+ * @param state true to enable, false to disable
+ */
+void destinationEnable(uint8_t index, bool state);
+
+/**
+ * @brief Get the health state of a destination
+ * 
+ * @param index index of the destination
+ * @return true destination is enabled and available
+ * @return false destination is disabled or failed
+ */
+bool destinationHealth(uint8_t index);
+
+/**
+ * @brief Set the timeout for the UDP health check,
+ * a UDP destination fails if no message was received within the timeout
+ * 
+ * @param timeout timeout in ms, 0 disables the check
+ */
+void failover(uint32_t timeout);
+
+/**
+ * @brief Set the interface for a message type, if both UDP and TCP interfaces are used
+ * 
+ * @param type message type ROUTE_KEY, ROUTE_FADER, ROUTE_EXECUTOR_KNOB, ROUTE_COMMAND or ROUTE_OSC
+ * @param protocol UDPOSC or TCP, default is UDPOSC
+ */
+void route(route_t type, protocol_t protocol);
+
+/**
+ * @brief Get the interface used for a message type
+ * 
+ * @param type message type
+ * @return protocol_t UDPOSC or TCP
+ */
+protocol_t route(route_t type);
+
 /**
  * @brief Send OSC data to gma3 or external receiver
  * 
@@ -210,6 +1097,13 @@ class Parser {
 		 */
 		Parser(cbptr callback = nullptr);
 
+		/**
+		 * @brief Attach the parser to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
+
 		/**
 		 * @brief Return the dataPool pattern send by the console
 		 * 
@@ -253,12 +1147,57 @@ class Parser {
 		 */
 		float floatOSC();
 
+		/**
+		 * @brief Accept only messages whose address after the prefix begins with one of the filters,
+		 * for UDP only the first OSC_PEEK_SIZE bytes of a packet are read, a rejected packet or TCP message is not parsed,
+		 * without filters all messages with the prefix are accepted
+		 * 
+		 * @param address begin of the address after the prefix, e.g. "13.13.1.5." or "Page", the address is copied
+		 * @param first first number which follows the address, e.g. 201 for the executors 201 thru 216
+		 * @param last last number which follows the address
+		 * @return int8_t index of the filter, -1 if all FILTER_RULES are used or the address is too long
+		 */
+		int8_t filter(const char *address);
+		int8_t filter(const char *address, int32_t first, int32_t last);
+
+		/**
+		 * @brief Change a filter, e.g. for the current page in the callback of Pages,
+		 * in threaded mode on the task of the Parser
+		 * 
+		 * @param index index of the filter
+		 * @param address begin of the address after the prefix
+		 * @param first first number which follows the address
+		 * @param last last number which follows the address
+		 * @return true changed
+		 * @return false no filter with this index or the address is too long
+		 */
+		bool filterChange(uint8_t index, const char *address);
+		bool filterChange(uint8_t index, const char *address, int32_t first, int32_t last);
+
+		/**
+		 * @brief Remove all filters, all messages with the prefix are accepted
+		 * 
+		 */
+		void filterClear();
+
 		void update();
 
 	private:
-		void parseOSC();
-		bool receiveUDP();
-		bool receiveTCP();
+		Gma3Context *context = &gma3;
+		bool parseOSC(Stream &stream, int32_t buffered, int32_t remaining, bool *starved = nullptr);
+		bool receiveUDP(UDP &udp);
+		bool receiveTCP(Client &tcp, uint8_t index);
+		bool tcpSkip(Client &tcp);
+		void tcpReset();
+		bool accept(const char *pattern, int32_t length);
+		bool filterSet(uint8_t index, const char *address, int32_t first, int32_t last);
+		struct Filter filters[FILTER_RULES];
+		uint8_t filterCount = 0;
+		int8_t tcpPending = -1; // destination with a partial message, -1 if none
+		int32_t tcpBuffered = 0; // bytes of the partial message in the receive buffer
+		uint32_t tcpTime = 0; // ms, last segment of the partial message
+		int8_t tcpResync = -1; // TCP destination which skips the rest of a lost message
+		uint8_t tcpOffset = 0; // position in the lost message modulo 4
 		int dataValue[5];
 		cbptr callback = nullptr;
 		struct Data receiveData;
@@ -287,6 +1226,13 @@ class Pools {
 		Pools(uint8_t pinUp, uint8_t pinDown, uint8_t poolsStart, uint8_t poolsEnd, send_t mode = GLOBAL, cbptr callback = nullptr);
 		Pools(uint8_t poolsStart, uint8_t poolsEnd, send_t mode = GLOBAL, cbptr callback = nullptr);
 
+		/**
+		 * @brief Attach the pools to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
+
 		/**
 		 * @brief Get the current common pool number
 		 * 
@@ -310,16 +1256,36 @@ class Pools {
 		void update();
 		void update(bool stateUp, bool stateDown);
 
+		/**
+		 * @brief Send the values of all unlocked faders after a pool change
+		 * 
+		 * @param state true to enable, false to disable
+		 */
+		void resync(bool state = true);
+
+		/**
+		 * @brief Send pool changes as OSC message with an integer argument instead of a command,
+		 * the prefix is added automatically
+		 * 
+		 * @param address OSC address without prefix, e.g. "Pool", an empty string uses the command again
+		 */
+		void address(const char *address);
+
 	private:
+		Gma3Context *context = &gma3;
 		void sendPool(uint16_t pool);
-		uint8_t pinUp;
-		uint8_t pinUpLast;
-		uint8_t pinDown;
-		uint8_t pinDownLast;
+		void change();
+		bool resyncState = false;
+		bool published = false; // the first pool is set in the context
+		char addressString[NAME_LENGTH_MAX] = "";
+		uint8_t pinUp = 0;
+		uint8_t pinUpLast = false; // virtual buttons start released like global objects
+		uint8_t pinDown = 0;
+		uint8_t pinDownLast = false;
 		uint16_t poolsStart;
 		uint16_t poolsEnd;
 		uint16_t poolNumber = 1;
-		uint16_t poolLast;
+		uint16_t poolLast = 1;
 		send_t mode;
 		cbptr callback;
 	};
@@ -346,6 +1312,13 @@ class Pages {
 		Pages(uint8_t pinUp, uint8_t pinDown, uint8_t pagesStart, uint8_t pagesEnd, send_t mode = GLOBAL, cbptr callback = nullptr);
 		Pages(uint8_t pagesStart, uint8_t pagesEnd, send_t mode = GLOBAL, cbptr callback = nullptr);
 
+		/**
+		 * @brief Attach the pages to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
+
 		/**
 		 * @brief Get the current common page number
 		 * 
@@ -368,16 +1341,37 @@ class Pages {
 		 */
 		void update();
 		void update(bool stateUp, bool stateDown);
+
+		/**
+		 * @brief Send the values of all unlocked faders after a page change
+		 * 
+		 * @param state true to enable, false to disable
+		 */
+		void resync(bool state = true);
+
+		/**
+		 * @brief Send page changes as OSC message with an integer argument instead of a command,
+		 * the prefix is added automatically
+		 * 
+		 * @param address OSC address without prefix, e.g. "Page", an empty string uses the command again
+		 */
+		void address(const char *address);
+
 	private:
+		Gma3Context *context = &gma3;
 		void sendPage(uint16_t page);
-		uint8_t pinUp;
-		uint8_t pinUpLast;
-		uint8_t pinDown;
-		uint8_t pinDownLast;
+		void change();
+		bool resyncState = false;
+		bool published = false; // the first page is set in the context
+		char addressString[NAME_LENGTH_MAX] = "";
+		uint8_t pinUp = 0;
+		uint8_t pinUpLast = false; // virtual buttons start released like global objects
+		uint8_t pinDown = 0;
+		uint8_t pinDownLast = false;
 		uint16_t pagesStart;
 		uint16_t pagesEnd;
 		uint16_t pageNumber = 1;
-		uint16_t pageLast;
+		uint16_t pageLast = 1;
 		send_t mode;
 		cbptr callback;
 	};
@@ -396,6 +1390,22 @@ class Key {
 		 */
 		Key(uint8_t pin, uint16_t key);
 		Key(uint16_t key);
+		Key(const Key &key);
+		Key& operator=(const Key&) = delete; // the links of the context must not be copied
+
+		/**
+		 * @brief Destroy the Key object, it is removed from its context,
+		 * so a key can also be a local or dynamic object
+		 * 
+		 */
+		~Key();
+
+		/**
+		 * @brief Attach the key to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
 
 		/**
 		 * @brief Set a local pool number
@@ -420,8 +1430,13 @@ class Key {
 		void update(bool state);
 
 	private:
-  	uint8_t pin;
-		uint8_t last;
+		Gma3Context *context = &gma3;
+		friend class Gma3Context;
+		void link();
+		void unlink();
+		Key *keyNext;
+  	uint8_t pin = 0;
+		uint8_t last = LOW; // virtual keys start released like global objects
 		uint16_t key;
 		uint16_t poolLocal = 0;
 		uint16_t pageLocal = 0;
@@ -441,6 +1456,22 @@ class Fader {
 		 */
 		Fader(uint8_t analogPin, uint16_t fader);
 		Fader(uint16_t fader);
+		Fader(const Fader &fader);
+		Fader& operator=(const Fader&) = delete; // the links of the context must not be copied
+
+		/**
+		 * @brief Destroy the Fader object, it is removed from its context,
+		 * so a fader can also be a local or dynamic object
+		 * 
+		 */
+		~Fader();
+
+		/**
+		 * @brief Attach the fader to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
 
 		/**
 		 * @brief Set a local pool number
@@ -501,16 +1532,32 @@ class Fader {
 		void update();
 		void update(uint16_t value);
 
+		/**
+		 * @brief Send the values of all unlocked faders of the default context which use the common page or pool,
+		 * the messages are send as OSC bundles
+		 * 
+		 * @param page true for a page change, false for a pool change
+		 */
+		static void resync(bool page = true);
+
 	private:
+		Gma3Context *context = &gma3;
+		friend class Gma3Context;
+		friend class Recorder;
+		void link();
+		void unlink();
+		void send();
+		Fader *faderNext;
 		bool lockState = false;
-		uint8_t analogPin;
-		uint8_t delta;
+		bool sendPending = false; // deferred by the rate limit
+		uint8_t analogPin = 0;
+		uint8_t delta = 0;
 		uint16_t fader;
 		int16_t poolLocal = 0;
 		uint16_t pageLocal = 0;
-		int16_t fetchValue;
+		int16_t fetchValue = 0;
 		int16_t analogLast;
-		int32_t valueLast;
+		int32_t valueLast = 0;
 		uint32_t updateTime;
 	};
 
@@ -530,6 +1577,22 @@ class ExecutorKnob {
 		 */
 		ExecutorKnob(uint8_t pinA, uint8_t pinB, uint16_t executorKnob, uint8_t direction = FORWARD);
 		ExecutorKnob(uint16_t executorKnob, uint8_t direction = FORWARD);
+		ExecutorKnob(const ExecutorKnob &knob);
+		ExecutorKnob& operator=(const ExecutorKnob&) = delete; // the links of the context must not be copied
+
+		/**
+		 * @brief Destroy the ExecutorKnob object, it is removed from its context,
+		 * so an executorKnob can also be a local or dynamic object
+		 * 
+		 */
+		~ExecutorKnob();
+
+		/**
+		 * @brief Attach the executorKnob to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
 
 		/**
 		 * @brief Set a local pool number
@@ -555,13 +1618,20 @@ class ExecutorKnob {
 		void update(uint8_t stateA, uint8_t stateB);
 	
 	private:
-		uint8_t pinA;
-		uint8_t pinB;
-		uint8_t pinALast;
-		uint8_t pinACurrent;
+		Gma3Context *context = &gma3;
+		friend class Gma3Context;
+		void link();
+		void unlink();
+		void send();
+		ExecutorKnob *executorKnobNext;
+		uint8_t pinA = 0;
+		uint8_t pinB = 0;
+		uint8_t pinALast = 0;
+		uint8_t pinACurrent = 0;
 		uint8_t direction;
-		uint8_t value;
-		int8_t encoderMotion;
+		uint8_t value = 0;
+		int8_t encoderMotion = 0;
+		int16_t encoderPending = 0; // steps deferred by the rate limit
 		uint16_t executorKnob;
 		uint16_t poolLocal = 0;
 		uint16_t pageLocal = 0;
@@ -577,10 +1647,20 @@ class CmdButton {
 		 * @brief Construct a new CmdButton object
 		 * 
 		 * @param pin button pin, not needed for virtual devices
-		 * @param command command string
+		 * @param command command string or F() string in flash memory, the string is not copied and must exist as long as the object,
+		 * a string with several lines is a macro sequence with waits if GMA3_MACROS is set, refer to Gma3Context::macro()
 		 */
 		CmdButton(uint8_t pin, const char *command);
+		CmdButton(uint8_t pin, const __FlashStringHelper *command);
 		CmdButton(const char *command);
+		CmdButton(const __FlashStringHelper *command);
+
+		/**
+		 * @brief Attach the cmdButton to a context, default is gma3
+		 * 
+		 * @param context 
+		 */
+		void attach(Gma3Context &context);
 
 		/**
 		 * @brief Update the state of the cmdButton, must in loop()
@@ -591,11 +1671,287 @@ class CmdButton {
 		void update(bool state);
 
 	private:
-		uint8_t pin;
-  	uint8_t last;
-		char cmdString[OSC_STRING_SIZE];
+		Gma3Context *context = &gma3;
+		void send();
+		uint8_t pin = 0;
+  	uint8_t last = LOW; // virtual buttons start released like global objects
+		bool flash = false;
+		const char *command; // RAM or flash memory, not copied
 	};
 
+/**
+ * @brief Recorder object for fader motions, the moves of all faders of a context are stored
+ * as compact time and value differences in an arena of the sketch, the playback sends them
+ * through the faders at the original timing
+ *
+ */
+class Recorder {
+	public:
+		/**
+		 * @brief Construct a new Recorder object
+		 *
+		 * @param arena memory for the events, about 3 bytes per fader move, not copied and must exist as long as the object
+		 * @param size size of the arena in bytes
+		 */
+		Recorder(uint8_t *arena, uint32_t size);
+		Recorder(const Recorder&) = delete; // a recording recorder is registered in the context
+		Recorder& operator=(const Recorder&) = delete;
+
+		/**
+		 * @brief Destroy the Recorder object, a running recording is stopped
+		 *
+		 */
+		~Recorder();
+
+		/**
+		 * @brief Attach the recorder to a context, default is gma3
+		 *
+		 * @param context
+		 */
+		void attach(Gma3Context &context);
+
+		/**
+		 * @brief Start a new recording, the previous recording is overwritten,
+		 * all values sent by the faders of the context are recorded until stop() or the arena is full
+		 *
+		 * @return true recording started
+		 * @return false another recorder of the context is recording
+		 */
+		bool record();
+
+		/**
+		 * @brief Start the playback of the recording
+		 *
+		 * @param repeat true to repeat the recording until stop()
+		 */
+		void play(bool repeat = false);
+
+		/**
+		 * @brief Stop the recording or playback
+		 *
+		 */
+		void stop();
+
+		/**
+		 * @brief Send the due fader values of the playback, must in loop()
+		 *
+		 */
+		void update();
+
+		/**
+		 * @brief Return the recording state
+		 *
+		 * @return true recording
+		 * @return false stopped or playing
+		 */
+		bool recording();
+
+		/**
+		 * @brief Return the playback state
+		 *
+		 * @return true playing
+		 * @return false stopped or recording
+		 */
+		bool playing();
+
+		/**
+		 * @brief Check if the last recording was stopped because the arena was full
+		 *
+		 * @return true arena full
+		 * @return false
+		 */
+		bool full();
+
+		/**
+		 * @brief Get the used bytes of the arena
+		 *
+		 * @return uint32_t size of the recorded events
+		 */
+		uint32_t size();
+
+		/**
+		 * @brief Get the length of the recording
+		 *
+		 * @return uint32_t duration in ms
+		 */
+		uint32_t duration();
+
+		/**
+		 * @brief Write the recording, e.g. to a file or EEPROM
+		 *
+		 * @param output Print object, e.g. FilePrint on the host or a File on a SD card
+		 * @return size_t written bytes
+		 */
+		size_t save(Print &output);
+
+		/**
+		 * @brief Read a recording written by save(), a running recording or playback is stopped
+		 *
+		 * @param input Stream object, e.g. FileStream on the host or a File on a SD card
+		 * @return true recording loaded
+		 * @return false wrong header or version, recording larger than the arena or truncated
+		 */
+		bool load(Stream &input);
+
+	private:
+		Gma3Context *context = &gma3;
+		friend class Fader;
+		void add(uint16_t fader, int32_t value);
+		void rewind();
+		uint8_t *arena;
+		uint32_t capacity;
+		uint32_t length = 0; // used bytes
+		uint32_t position = 0; // next event of the playback
+		uint32_t startTime = 0; // ms
+		uint32_t eventTime = 0; // ms since start of the previous event
+		uint32_t recordDuration = 0; // ms
+		int32_t faderPrevious = 0;
+		int32_t valuePrevious = 0;
+		uint8_t mode = 0; // stopped, recording or playing
+		bool repeat = false;
+		bool overflow = false;
+	};
+
+/**
+ * @brief Output for the indicators, e.g. a 74HC595 chain, a WS2812 strip or a PWM driver,
+ * implemented by the sketch
+ * 
+ */
+class IndicatorSink {
+	public:
+		virtual void write(uint16_t channel, const uint8_t *values, uint16_t count) = 0; // a run of changed channels
+		virtual void show() {} // end of the frame, e.g. the latch of a 74HC595 chain or show() of a LED strip
+	};
+
+/**
+ * @brief Indicator channels fed from the console feedback, only the changed channels are
+ * sent to the sink, once per frame, the buffers are owned by Indicators
+ * 
+ */
+class IndicatorOutput {
+	public:
+		/**
+		 * @brief Assign the feedback of an executor to a channel, several channels can show the same executor,
+		 * e.g. the red, green and blue channel of a LED
+		 * 
+		 * @param executor number of the executor, the last number of the pattern, e.g. 201 of 13.13.1.5.201
+		 * @param channel indicator channel
+		 * @param type INDICATOR_STATE for the integer argument, INDICATOR_LEVEL for the float argument
+		 * @param key string argument of the feedback, e.g. "Go+" or "FaderMaster", nullptr for all, not copied
+		 * @param on value of the channel for on or level 100
+		 * @param off value of the channel for off or level 0
+		 * @return int16_t index of the assignment, -1 if all assignments are used or the channel not exists
+		 */
+		int16_t assign(uint16_t executor, uint16_t channel, indicator_t type = INDICATOR_STATE, const char *key = nullptr, uint8_t on = 255, uint8_t off = 0);
+
+		/**
+		 * @brief Remove all assignments, the channels keep their values
+		 * 
+		 */
+		void assignClear();
+
+		/**
+		 * @brief Update the assigned channels with the message of the Parser, e.g. in the callback of the Parser
+		 * 
+		 * @param parser 
+		 */
+		void feed(Parser &parser);
+
+		/**
+		 * @brief Set a channel directly
+		 * 
+		 * @param channel 
+		 * @param value 
+		 */
+		void set(uint16_t channel, uint8_t value);
+
+		/**
+		 * @brief Get the value of a channel
+		 * 
+		 * @param channel 
+		 * @return uint8_t value, 0 if the channel not exists
+		 */
+		uint8_t get(uint16_t channel);
+
+		/**
+		 * @brief Set the frame interval
+		 * 
+		 * @param interval ms between two outputs to the sink, 0 sends the changes with every update()
+		 */
+		void frame(uint16_t interval);
+
+		/**
+		 * @brief Send all channels with the next frame, e.g. after the LEDs were powered up
+		 * 
+		 */
+		void refresh();
+
+		/**
+		 * @brief Send the changed channels to the sink when a frame is due, must in loop(),
+		 * feed() and update() must called from the same task
+		 * 
+		 */
+		void update();
+
+	protected:
+		IndicatorOutput(IndicatorSink &sink, uint8_t *values, uint8_t *dirty, uint16_t channels, struct IndicatorMap *maps, uint16_t mapCapacity)
+			: sink(&sink), values(values), dirty(dirty), channels(channels), maps(maps), mapCapacity(mapCapacity) {}
+
+	private:
+		IndicatorSink *sink;
+		uint8_t *values;
+		uint8_t *dirty; // bit per channel
+		uint16_t channels;
+		struct IndicatorMap *maps;
+		uint16_t mapCapacity;
+		uint16_t mapCount = 0;
+		uint16_t frameInterval = INDICATOR_FRAME_MS;
+		uint32_t frameTime = 0;
+		bool changed = false; // at least one dirty channel
+	};
+
+/**
+ * @brief Indicator output with its own buffers, e.g. Indicators<32> for four 74HC595
+ * 
+ * @tparam CHANNELS number of channels, e.g. 8 per 74HC595 or 3 per WS2812 LED
+ * @tparam MAPS max. number of assignments of executors to channels
+ */
+template <uint16_t CHANNELS, uint16_t MAPS = CHANNELS>
+class Indicators : public IndicatorOutput {
+	public:
+		Indicators(IndicatorSink &sink) : IndicatorOutput(sink, values, dirty, CHANNELS, maps, MAPS) {}
+
+	private:
+		uint8_t values[CHANNELS] = {};
+		uint8_t dirty[(CHANNELS + 7) / 8] = {};
+		struct IndicatorMap maps[MAPS] = {};
+	};
+
+#if GMA3_STATISTICS
+/**
+ * @brief Get the statistics of the default context,
+ * the loop times are only measured if gma3.update() is called in loop()
+ * 
+ * @return const struct Statistics& counters for sent and received packets, errors and loop times
+ */
+const struct Statistics& statistics();
+
+/**
+ * @brief Reset all statistics counters
+ * 
+ */
+void statisticsReset();
+
+/**
+ * @brief Publish the statistics periodically as OSC bundle by gma3.update(),
+ * each counter is send to /prefix/address/counterName with an integer argument
+ * 
+ * @param address OSC address without prefix, e.g. "stats"
+ * @param interval interval in ms, 0 disables publishing
+ */
+void statisticsPublish(const char *address, uint32_t interval = 1000);
+#endif
+
 /**
  * @brief Creates osc messages with different data types and send it
  * 
@@ -607,6 +1963,19 @@ void oscMessage(const char pattern[], float float32);
 void oscMessage(const char pattern[], const char string[]);
 void oscMessage(const char pattern[]);
 
+/**
+ * @brief Collect all following OSC messages in a bundle until bundleEnd()
+ * 
+ * @param timetag OSC time for the execution of the bundle, TIMETAG_IMMEDIATE or e.g. gma3.timetag(millis() + 20)
+ */
+void bundleBegin(uint64_t timetag = TIMETAG_IMMEDIATE);
+
+/**
+ * @brief Send the collected OSC bundle
+ * 
+ */
+void bundleEnd();
+
 /**
  * @brief Big endian array to float conversation
  * 
@@ -644,7 +2013,25 @@ void ftoh(uint8_t *msg, uint8_t dataStart, float value);
 void itoh(uint8_t *msg, uint8_t dataStart, int32_t value);
 
 /**
- * @brief Integer to string conversation
+ * @brief Integer to decimal string conversion without stdio
+ * 
+ * @param buffer target, needs max. 12 bytes including the terminating 0
+ * @param number 
+ * @return uint8_t length of the string without the terminating 0
+ */
+uint8_t itod(char *buffer, int32_t number);
+
+/**
+ * @brief Decimal string to integer conversion without stdio
+ * 
+ * @param string source, an optional sign followed by digits
+ * @param number result, unchanged if there are no digits
+ * @return uint8_t number of characters used, 0 if there are no digits
+ */
+uint8_t dtoi(const char *string, int32_t &number);
+
+/**
+ * @brief Integer to string conversation, uses a static buffer and is not re-entrant, use itod() instead
  * 
  * @param number 
  * @return const char* 